@@ -0,0 +1,834 @@
+#pragma once
+
+#include "platform.h"
+#include "canvas.h"
+#include "arena.h"
+#include "color.h"
+#include "gradient.h"
+#include "profile.h"
+#include "random.h"
+#include "sprite.h"
+
+// Base of the actors drawing into a canvas of Length pixels, TActor draws into the canvas of all strips
+template <unsigned int Length>
+class TActorOf {
+public:
+    unsigned long Period = 1000; // ms
+    uint32_t LastDrawTime = 0; // ms
+
+    virtual ~TActorOf() = default;
+
+    // actors only live in TActorArena, so strategy switches never touch the heap
+    static void* operator new(size_t) = delete;
+
+    static void operator delete(void* ptr) {
+        TActorArena::Get().Free(ptr);
+    }
+
+    // so that a long stall is skipped rather than made up for by a burst of steps
+    static constexpr uint32_t MAX_CATCH_UP = 100; // ms
+
+    virtual void Draw(TCanvasOf<Length>&) = 0;
+    // returns true when the canvas content has changed, now is millis() taken once for the whole frame
+    virtual bool Move(TCanvasOf<Length>&, uint32_t now) = 0;
+
+    // signed, so that a LastDrawTime postponed into the future works
+    long GetTimeLeft(uint32_t now) const {
+        return long(Period) - long(int32_t(now - LastDrawTime));
+    }
+
+    // true while a step is due, each call books one Period, so a frame coming late makes up for the
+    // steps it has missed and motion keeps its speed whatever the frame rate. The first call always steps.
+    // Actors drawing over what they drew before draw after every step, so none of them goes missing.
+    bool NextStep(uint32_t now) {
+        if (!Started) {
+            Started = true;
+            LastDrawTime = now;
+            return true;
+        }
+        long late = -GetTimeLeft(now);
+        if (late < 0) {
+            return false;
+        }
+        LastDrawTime = late > long(MAX_CATCH_UP) ? now - MAX_CATCH_UP : LastDrawTime + Period;
+        return true;
+    }
+
+    void PostponeTime(uint32_t now, uint32_t ahead) {
+        LastDrawTime = now + ahead;
+    }
+
+    // makes the next DrawIfChanged() redraw, also for when something else has written to the canvas
+    void Invalidate() {
+        Changed = true;
+    }
+
+    // ms until Move() has something new to draw, the frame scheduler sleeps through the frames before that
+    virtual uint32_t GetIdleTime(uint32_t now) const {
+        long left = GetTimeLeft(now);
+        return Changed || left <= 0 ? 0 : left;
+    }
+
+    bool DrawIfChanged(TCanvasOf<Length>& canvas) {
+        if (!Changed) {
+            return false;
+        }
+#if LED300_PROFILE
+        uint32_t start = micros();
+        Draw(canvas);
+        TProfiler::Get().AddDraw(micros() - start);
+#else
+        Draw(canvas);
+#endif
+        Changed = false;
+        return true;
+    }
+
+    static constexpr uint32_t IDLE_FOREVER = 0xFFFFFFFF;
+
+protected:
+    bool Changed = true;
+    bool Started = false; // LastDrawTime holds the time of the last step
+};
+
+using TActor = TActorOf<NUM_LEDS>;
+
+template <typename T, int S>
+T GetRandom(const T(&choices)[S]) {
+    return choices[RandomBelow(S)];
+}
+
+// a choice other than result in one draw over the other choices, any choice when result isn't
+// one of them; the choices are expected to differ from each other
+template <typename T, int S>
+void MakeRandom(T& result, const T(&choices)[S]) {
+    int skip = 0;
+    while (skip < S && !(choices[skip] == result)) {
+        ++skip;
+    }
+    if (skip == S) {
+        result = choices[RandomBelow(S)];
+        return;
+    }
+    int r = RandomBelow(S - 1);
+    result = choices[r < skip ? r : r + 1];
+}
+
+template <typename T>
+void MakeRandom(T& result, const T(&choices)[1]) {
+    result = choices[0];
+}
+
+// index of a random choice, for pixels stored as palette indices
+template <typename T, int S>
+uint8_t GetRandomIndex(const T(&)[S]) {
+    static_assert(S <= 256, "palette indices are 8 bit");
+    return RandomBelow(S);
+}
+
+template <typename PatternType, unsigned int Length = NUM_LEDS>
+class TPatternActor : public TActorOf<Length> {
+public:
+    TPatternActor(const PatternType& pattern, int step = 1, bool repeat = false, int space = 0)
+        : Pattern(pattern)
+        , Step(step)
+        , Repeat(repeat)
+        , Space(space)
+    {
+        this->Period = 50;
+    }
+
+    virtual void Draw(TCanvasOf<Length>& canvas) override {
+        if (Repeat) {
+            for (unsigned int i = 0; i < Length; ++i) {
+                canvas.Set(canvas.Wrap(I + i), Pattern[i % countof(Pattern)]);
+                if (Space && (i % countof(Pattern)) == countof(Pattern) - 1) {
+                    i += Space;
+                }
+            }
+        } else {
+            for (unsigned int i = 0; i < countof(Pattern); ++i) {
+                canvas.Set(canvas.Wrap(I + i), Pattern[i]);
+            }
+        }
+    }
+
+    virtual bool Move(TCanvasOf<Length>& canvas, uint32_t now) override {
+        bool changed = this->DrawIfChanged(canvas);
+        while (this->NextStep(now)) {
+            I = canvas.Wrap(I + Step);
+            this->Invalidate();
+            changed |= this->DrawIfChanged(canvas);
+        }
+        return changed;
+    }
+
+protected:
+    const PatternType& Pattern;
+    int Step;
+    bool Repeat;
+    int Space;
+    int I = 0;
+};
+
+template <typename PatternType, unsigned int Length = NUM_LEDS>
+class TSmoothPatternActor : public TActorOf<Length>, TColorSmoother {
+public:
+    static constexpr int SMOOTH_LEVEL = 20;
+
+    TSmoothPatternActor(const PatternType& pattern, bool repeat = false)
+        : Pattern(pattern)
+        , Repeat(repeat)
+    {
+        this->Period = 1;
+        if (Repeat) {
+            for (unsigned int i = 0; i < Length; ++i) {
+                PixelsDesired[i] = Pattern[i % countof(Pattern)];
+            }
+        } else {
+            for (unsigned int i = 0; i < countof(Pattern); ++i) {
+                PixelsDesired[i] = Pattern[i];
+            }
+        }
+    }
+
+    virtual void Draw(TCanvasOf<Length>& canvas) override {
+        SmoothApply(canvas, PixelsDesired, GetMergeAmount(S, SMOOTH_LEVEL));
+    }
+
+    virtual bool Move(TCanvasOf<Length>& canvas, uint32_t now) override {
+        while (this->NextStep(now)) {
+            S = (S + 1) % SMOOTH_LEVEL;
+            if (S == 0) {
+                PixelsDesired.RotateUp();
+            }
+            this->Invalidate();
+        }
+        return this->DrawIfChanged(canvas);
+    }
+
+protected:
+    const PatternType& Pattern;
+    TPixelRing<Length> PixelsDesired;
+    bool Repeat;
+    int S = 0;
+};
+
+template <typename PatternType, unsigned int Length = NUM_LEDS>
+class TChaoticPatternMovementActor : public TActorOf<Length> {
+public:
+    TChaoticPatternMovementActor(const PatternType& pattern)
+        : Pattern(pattern)
+    {
+        this->Period = 1;
+    }
+
+    virtual void Draw(TCanvasOf<Length>& canvas) override {
+        for (unsigned int i = 0; i < countof(Pattern); ++i) {
+            canvas.Set(canvas.Wrap(I + i), Pattern[i]);
+        }
+    }
+
+    virtual bool Move(TCanvasOf<Length>& canvas, uint32_t now) override {
+        bool changed = this->DrawIfChanged(canvas);
+        while (this->NextStep(now)) {
+            this->Period = 1;
+            I = canvas.Wrap(I + Step);
+            if (I == D) {
+                D = RandomBelow(Length);
+                if (D > I) {
+                    Step = 1;
+                } else if (D < I) {
+                    Step = -1;
+                } else {
+                    Step = 0;
+                }
+                this->Period = 100;
+            }
+            this->Invalidate();
+            changed |= this->DrawIfChanged(canvas);
+        }
+        return changed;
+    }
+
+protected:
+    const PatternType& Pattern;
+    int I = 0;
+    int Step = 0;
+    int D = 0;
+};
+
+template <typename PatternType, unsigned int Length = NUM_LEDS>
+class TChaoticPatternMovementWithRandomTrailActor : public TActorOf<Length> {
+public:
+    TChaoticPatternMovementWithRandomTrailActor(const PatternType& pattern)
+        : Pattern(pattern)
+    {
+        this->Period = 1;
+    }
+
+    virtual void Draw(TCanvasOf<Length>& canvas) override {
+        for (unsigned int i = 0; i < countof(Pattern); ++i) {
+            canvas.Set(canvas.Wrap(I + i), Pattern[i]);
+        }
+        if (Step < 0) {
+            canvas.Set(canvas.Wrap(I + countof(Pattern) + 1), Trail);
+        }
+        if (Step > 0) {
+            canvas.Set(canvas.Wrap(I + Length - 1), Trail);
+        }
+    }
+
+    virtual bool Move(TCanvasOf<Length>& canvas, uint32_t now) override {
+        bool changed = this->DrawIfChanged(canvas);
+        while (this->NextStep(now)) {
+            this->Period = 1;
+            if (D > I) {
+                Step = 1;
+            } else if (D < I) {
+                Step = -1;
+            }
+            I = canvas.Wrap(I + Step);
+            if (I == D) {
+                D = RandomBelow(Length);
+                Trail = TRandom::Get().Color(0x10);
+                this->Period = 10;
+            }
+            this->Invalidate();
+            changed |= this->DrawIfChanged(canvas);
+        }
+        return changed;
+    }
+
+protected:
+    const PatternType& Pattern;
+    int I = 0;
+    int Step = 0;
+    int D = 0;
+    uint32_t Trail = 0;
+};
+
+template <unsigned int Length = NUM_LEDS>
+class TRandomFillActor : public TActorOf<Length> {
+    uint32_t Pixels[Length];
+
+public:
+    TRandomFillActor() {
+        this->Period = 5000;
+    }
+
+    virtual void Draw(TCanvasOf<Length>& canvas) override {
+        canvas.Write(0, Pixels, countof(Pixels));
+    }
+
+    virtual bool Move(TCanvasOf<Length>& canvas, uint32_t now) override {
+        while (this->NextStep(now)) {
+            TRandom::Get().FillColors(Pixels, countof(Pixels));
+            this->Invalidate();
+        }
+        return this->DrawIfChanged(canvas);
+    }
+};
+
+template <unsigned int Length = NUM_LEDS>
+class TRandomShifterActor : public TActorOf<Length> {
+    TPixelRing<Length> Pixels;
+
+public:
+    TRandomShifterActor() {
+        this->Period = 5;
+    }
+
+    virtual void Draw(TCanvasOf<Length>& canvas) override {
+        Pixels.Draw(canvas);
+    }
+
+    virtual bool Move(TCanvasOf<Length>& canvas, uint32_t now) override {
+        while (this->NextStep(now)) {
+            Pixels.RotateUp();
+            Pixels[0] = TRandom::Get().Color();
+            this->Invalidate();
+        }
+        return this->DrawIfChanged(canvas);
+    }
+};
+
+template <typename ColorsType, unsigned int Length = NUM_LEDS>
+class TRandomSelectorShifterActor : public TActorOf<Length> {
+    TPixelRing<Length, uint8_t> Pixels;
+
+public:
+    TRandomSelectorShifterActor(const ColorsType& colors)
+        : Colors(colors)
+    {
+        this->Period = 10;
+        for (unsigned int i = 0; i < Length; ++i) {
+            Pixels[i] = GetRandomIndex(Colors);
+        }
+    }
+
+    virtual void Draw(TCanvasOf<Length>& canvas) override {
+        Pixels.Draw(canvas, Colors);
+    }
+
+    virtual bool Move(TCanvasOf<Length>& canvas, uint32_t now) override {
+        while (this->NextStep(now)) {
+            Pixels.RotateUp();
+            this->Invalidate();
+        }
+        return this->DrawIfChanged(canvas);
+    }
+
+protected:
+    const ColorsType& Colors;
+};
+
+template <typename ColorsType, unsigned int Length = NUM_LEDS>
+class TRandomSelectorSmoothShifterActor : public TActorOf<Length>, TColorSmoother {
+    TPixelRing<Length, uint8_t> PixelsDesired;
+    static constexpr int MAX_SHIFT = 10;
+    int Shift = 0;
+
+public:
+    TRandomSelectorSmoothShifterActor(const ColorsType& colors)
+        : Colors(colors)
+    {
+        this->Period = 10;
+        for (unsigned int i = 0; i < Length; ++i) {
+            PixelsDesired[i] = GetRandomIndex(Colors);
+        }
+    }
+
+    virtual void Draw(TCanvasOf<Length>& canvas) override {
+        SmoothApply(canvas, PixelsDesired, Colors, GetMergeAmount(Shift, MAX_SHIFT));
+    }
+
+    virtual bool Move(TCanvasOf<Length>& canvas, uint32_t now) override {
+        while (this->NextStep(now)) {
+            Shift = (Shift + 1) % MAX_SHIFT;
+            if (Shift == 0) {
+                PixelsDesired.RotateUp();
+            }
+            this->Invalidate();
+        }
+        return this->DrawIfChanged(canvas);
+    }
+
+protected:
+    const ColorsType& Colors;
+};
+
+template <typename ColorsType, unsigned int Length = NUM_LEDS>
+class TRandomSmoothBlenderActor : public TActorOf<Length>, TColorSmoother {
+    uint8_t Pixels[Length];
+    uint8_t PixelsDesired[Length];
+    static constexpr int MAX_SHIFT = 50;
+    int Shift = 0;
+
+public:
+    // starts from random colours rather than from the canvas, which palette indices can't hold
+    TRandomSmoothBlenderActor(const ColorsType& colors)
+        : Colors(colors)
+    {
+        this->Period = 100;
+        for (unsigned int i = 0; i < Length; ++i) {
+            Pixels[i] = GetRandomIndex(Colors);
+            PixelsDesired[i] = GetRandomIndex(Colors);
+        }
+    }
+
+    virtual void Draw(TCanvasOf<Length>& canvas) override {
+        uint32_t amount = GetMergeAmount(Shift, MAX_SHIFT);
+        uint32_t* pixels = canvas.GetPixels();
+        for (unsigned int i = 0; i < Length; ++i) {
+            pixels[i] = MergeColors(Colors[Pixels[i]], Colors[PixelsDesired[i]], amount);
+        }
+    }
+
+    virtual bool Move(TCanvasOf<Length>& canvas, uint32_t now) override {
+        while (this->NextStep(now)) {
+            Shift = (Shift + 1) % MAX_SHIFT;
+            if (Shift == 0) {
+                for (unsigned int i = 0; i < Length; ++i) {
+                    Pixels[i] = PixelsDesired[i];
+                    PixelsDesired[i] = GetRandomIndex(Colors);
+                }
+            }
+            this->Invalidate();
+        }
+        return this->DrawIfChanged(canvas);
+    }
+
+protected:
+    const ColorsType& Colors;
+};
+
+template <typename ColorsType, unsigned int Length = NUM_LEDS>
+class TRandomFastBlenderActor : public TActorOf<Length>, TColorSmoother {
+    TPixelRing<Length> Pixels;
+    uint32_t StartingColor;
+    uint32_t DesiredColor;
+    static constexpr int MAX_SHIFT = 50;
+    int Shift = 0;
+
+public:
+    TRandomFastBlenderActor(const ColorsType& colors, TCanvasOf<Length>& canvas)
+        : Colors(colors)
+    {
+        this->Period = 10;
+        DesiredColor = GetRandom(Colors);
+        Pixels.Read(canvas);
+        StartingColor = Pixels[0];
+    }
+
+    virtual void Draw(TCanvasOf<Length>& canvas) override {
+        Pixels.Draw(canvas);
+    }
+
+    virtual bool Move(TCanvasOf<Length>& canvas, uint32_t now) override {
+        while (this->NextStep(now)) {
+            Pixels.RotateUp();
+            Shift = (Shift + 1) % MAX_SHIFT;
+            if (Shift == 0) {
+                Pixels[0] = StartingColor = DesiredColor;
+                MakeRandom(DesiredColor, Colors);
+            } else {
+                Pixels[0] = MergeColors(StartingColor, DesiredColor, GetMergeAmount(Shift, MAX_SHIFT));
+            }
+            this->Invalidate();
+        }
+        return this->DrawIfChanged(canvas);
+    }
+
+protected:
+    const ColorsType& Colors;
+};
+
+template <typename ColorsType, unsigned int Length = NUM_LEDS>
+class TSingleRandomSmoothBlenderActor : public TActorOf<Length>, TColorSmoother {
+    uint32_t Pixels[Length];
+    uint32_t ColorDesired;
+    static constexpr int MAX_SHIFT = 250;
+    int Shift = 0;
+
+public:
+    TSingleRandomSmoothBlenderActor(const ColorsType& colors, TCanvasOf<Length>& canvas)
+        : Colors(colors)
+    {
+        this->Period = 10;
+        ColorDesired = GetRandom(Colors);
+        canvas.Read(0, Pixels, Length);
+    }
+
+    virtual void Draw(TCanvasOf<Length>& canvas) override {
+        uint32_t amount = GetMergeAmount(Shift, MAX_SHIFT - 1);
+        for (unsigned int i = 0; i < Length; ++i) {
+            canvas.Set(i, MergeColors(Pixels[i], ColorDesired, amount));
+        }
+    }
+
+    virtual bool Move(TCanvasOf<Length>& canvas, uint32_t now) override {
+        while (this->NextStep(now)) {
+            Shift = (Shift + 1) % MAX_SHIFT;
+            if (Shift == 0) {
+                for (unsigned int i = 0; i < Length; ++i) {
+                    Pixels[i] = ColorDesired;
+                }
+                MakeRandom(ColorDesired, Colors);
+                this->PostponeTime(this->LastDrawTime, 10000);
+            }
+            this->Invalidate();
+        }
+        return this->DrawIfChanged(canvas);
+    }
+
+protected:
+    const ColorsType& Colors;
+};
+
+// Draws a TGradient, scrolled on by Step per Period unless Step is 0. The canvas holds on to the
+// rendered gradient, so it is only rendered again when the stops or the phase change.
+template <unsigned int Length = NUM_LEDS>
+class TGradientActor : public TActorOf<Length> {
+public:
+    TGradientActor(int32_t step = 0)
+        : Step(step)
+    {
+        this->Period = 20;
+    }
+
+    void SetStops(const TGradientStop* stops, unsigned int count) {
+        Gradient.SetStops(stops, count);
+        this->Invalidate();
+    }
+
+    void SetColor(unsigned int index, uint32_t color) {
+        Gradient.SetColor(index, color);
+        this->Invalidate();
+    }
+
+    // END is a full turn
+    void SetPhase(uint32_t phase) {
+        Phase = phase % TGradient::END;
+        this->Invalidate();
+    }
+
+    virtual void Draw(TCanvasOf<Length>& canvas) override {
+        Gradient.Render(canvas.GetPixels(), Length, Phase);
+    }
+
+    virtual bool Move(TCanvasOf<Length>& canvas, uint32_t now) override {
+        while (Step != 0 && this->NextStep(now)) {
+            Phase = (Phase + uint32_t(Step)) % TGradient::END;
+            this->Invalidate();
+        }
+        return this->DrawIfChanged(canvas);
+    }
+
+    virtual uint32_t GetIdleTime(uint32_t now) const override {
+        if (Step != 0) {
+            return TActorOf<Length>::GetIdleTime(now);
+        }
+        return this->Changed ? 0 : TActorOf<Length>::IDLE_FOREVER;
+    }
+
+protected:
+    TGradient Gradient;
+    int32_t Step;
+    uint32_t Phase = 0;
+};
+
+template <unsigned int Length = NUM_LEDS>
+class TSingleColorGradientActor : public TGradientActor<Length> {
+public:
+    TSingleColorGradientActor(uint32_t color) {
+        const TGradientStop stops[] = {{0, 0x000000}, {TGradient::END, color}};
+        this->SetStops(stops, countof(stops));
+    }
+};
+
+enum class EDecayMode {
+    Linear, // every channel loses speed per step
+    Exponential, // every channel loses speed / 256 of itself per step
+};
+
+// Only the lit pixels are kept, in a list with their current colours, so a step costs as much
+// as there are splashes alive rather than the length of the canvas. A pixel leaves the list
+// once it is black; a splash landing while the list is full is dropped.
+template <typename ColorsType, unsigned int Length = NUM_LEDS>
+class TDecayingSplashesActor : public TActorOf<Length>, TColorSmoother {
+public:
+    static constexpr unsigned int MAX_SPLASHES = 128;
+
+    TDecayingSplashesActor(int amount, int speed, const ColorsType& colors, EDecayMode mode = EDecayMode::Linear)
+        : Amount(amount)
+        , Speed(min(speed, 255))
+        , Mode(mode)
+        , Colors(colors)
+    {
+        this->Period = 5;
+    }
+
+    virtual void Draw(TCanvasOf<Length>& canvas) override {
+        canvas.Fill(0, 0, Length);
+        uint32_t* pixels = canvas.GetPixels();
+        for (unsigned int s = 0; s < Count; ++s) {
+            pixels[Positions[s]] = Pixels[s];
+        }
+    }
+
+    virtual bool Move(TCanvasOf<Length>& canvas, uint32_t now) override {
+        while (this->NextStep(now)) {
+            if (Mode == EDecayMode::Linear) {
+                Decay([](uint32_t color, uint32_t speed) { return TSwar::Sub(color, speed * 0x010101); });
+            } else {
+                Decay([](uint32_t color, uint32_t speed) { return TSwar::Scale(color, 256 - speed); });
+            }
+            for (int i = 0; i < Amount; ++i) {
+                unsigned int index = RandomBelow(Length);
+                Light(index, Colors[GetRandomIndex(Colors)]);
+            }
+            this->Invalidate();
+        }
+        return this->DrawIfChanged(canvas);
+    }
+
+    unsigned int GetCount() const {
+        return Count;
+    }
+
+protected:
+    static_assert(MAX_SPLASHES < 256, "slots are 8 bit");
+
+    uint16_t Positions[MAX_SPLASHES];
+    uint32_t Pixels[MAX_SPLASHES];
+    uint8_t Slots[Length] = {}; // 1 + the list entry of a lit pixel, 0 for a black one
+    unsigned int Count = 0;
+    int Amount;
+    uint32_t Speed;
+    EDecayMode Mode;
+    const ColorsType& Colors;
+
+    template <typename DecayType>
+    void Decay(DecayType decay) {
+        unsigned int s = 0;
+        while (s < Count) {
+            uint32_t color = decay(Pixels[s], Speed);
+            if (color != 0) {
+                Pixels[s++] = color;
+                continue;
+            }
+            // the last entry takes the place of the black one
+            Slots[Positions[s]] = 0;
+            if (--Count != s) {
+                Positions[s] = Positions[Count];
+                Pixels[s] = Pixels[Count];
+                Slots[Positions[s]] = s + 1;
+            }
+        }
+    }
+
+    void Light(unsigned int index, uint32_t color) {
+        unsigned int slot = Slots[index];
+        if (slot != 0) {
+            Pixels[slot - 1] = color;
+        } else if (Count < MAX_SPLASHES) {
+            Positions[Count] = index;
+            Pixels[Count] = color;
+            Slots[index] = ++Count;
+        }
+    }
+};
+
+template <unsigned int Length = NUM_LEDS>
+class TSingleColorActor : public TActorOf<Length>, TColorSmoother {
+public:
+    TSingleColorActor(uint32_t color)
+        : Color(color)
+    {
+        this->Period = 1000;
+    }
+
+    virtual void Draw(TCanvasOf<Length>& canvas) override {
+        canvas.Fill(0, Color, Length);
+    }
+
+    virtual bool Move(TCanvasOf<Length>& canvas, uint32_t) override {
+        return this->DrawIfChanged(canvas);
+    }
+
+    virtual uint32_t GetIdleTime(uint32_t) const override {
+        return this->Changed ? 0 : TActorOf<Length>::IDLE_FOREVER;
+    }
+
+protected:
+    uint32_t Color;
+};
+
+template <typename ColorsType, unsigned int Length = NUM_LEDS>
+class TShiftRandomColorsActor : public TActorOf<Length>, TColorSmoother {
+public:
+    TShiftRandomColorsActor(const ColorsType& colors)
+        : Colors(colors)
+    {
+        this->Period = 50;
+        Color = GetRandom(Colors);
+    }
+
+    virtual void Draw(TCanvasOf<Length>& canvas) override {
+        for (unsigned int i = 0; i < Length; i += Distance) {
+            if (Pos % 2 == 0) {
+                canvas.Set(i + Distance / 2 + Pos / 2, Color);
+            } else {
+                canvas.Set(i + Distance / 2 - Pos / 2 - 1, Color);
+            }
+        }
+    }
+
+    virtual bool Move(TCanvasOf<Length>& canvas, uint32_t now) override {
+        bool changed = this->DrawIfChanged(canvas);
+        while (this->NextStep(now)) {
+            ++Pos;
+            if (Pos >= Distance) {
+                Pos = 0;
+                MakeRandom(Color, Colors);
+            }
+            this->Invalidate();
+            changed |= this->DrawIfChanged(canvas);
+        }
+        return changed;
+    }
+
+protected:
+    const ColorsType& Colors;
+    int Pos = 0;
+    int Distance = 50;
+    uint32_t Color;
+};
+
+// the colours spread evenly over the pixels
+template <typename ColorsType, unsigned int Length = NUM_LEDS>
+class TProportionalColorsActor : public TGradientActor<Length> {
+public:
+    TProportionalColorsActor(const ColorsType& colors, int32_t step = 0)
+        : TGradientActor<Length>(step)
+    {
+        this->Gradient.SetColors(colors);
+    }
+};
+
+template <typename AnimationType, int Count, unsigned int Length = NUM_LEDS>
+class TAnimationActor : public TActorOf<Length> {
+public:
+    TAnimationActor(const AnimationType& animation)
+        : Animation(animation)
+    {
+        this->Period = 20;
+        for (unsigned int i = 0; i < Count; ++i) {
+            Sprites[i] = -1;
+        }
+    }
+
+    // from black, a sprite that has ended between two frames mustn't stay behind
+    virtual void Draw(TCanvasOf<Length>& canvas) override {
+        canvas.Fill(0, 0, Length);
+        for (unsigned int i = 0; i < Count; ++i) {
+            if (Sprites[i] >= 0) {
+                Animation.Draw(canvas, Sprites[i], Positions[i]);
+            }
+        }
+    }
+
+    virtual bool Move(TCanvasOf<Length>& canvas, uint32_t now) override {
+        while (this->NextStep(now)) {
+            // started when the step was due rather than when the frame came
+            Animations[AnimationNum].Start(this->LastDrawTime);
+            Positions[AnimationNum] = RandomBelow(Length - Animation.GetSize() + 1);
+            AnimationNum = (AnimationNum + 1) % Count;
+        }
+        for (unsigned int i = 0; i < Count; ++i) {
+            int sprite = Animations[i].GetCurrentSprite(Animation, now);
+            if (sprite != Sprites[i]) {
+                Sprites[i] = sprite;
+                this->Invalidate();
+            }
+        }
+        return this->DrawIfChanged(canvas);
+    }
+
+    // until the next animation starts or a sprite that is playing switches
+    virtual uint32_t GetIdleTime(uint32_t now) const override {
+        uint32_t idleTime = TActorOf<Length>::GetIdleTime(now);
+        for (unsigned int i = 0; i < Count; ++i) {
+            idleTime = min(idleTime, Animations[i].GetTimeLeft(Animation, now));
+        }
+        return idleTime;
+    }
+
+protected:
+    const AnimationType& Animation;
+    TAnimationPlay Animations[Count];
+    int Sprites[Count]; // -1 while nothing is shown
+    int Positions[Count] = {};
+    int AnimationNum = 0;
+};
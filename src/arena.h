@@ -0,0 +1,115 @@
+#pragma once
+
+#include <new>
+#include <stddef.h>
+#include <utility>
+#include "platform.h"
+#include "canvas.h"
+
+// Fixed number of equally sized slots in static memory. Allocating takes the first free slot,
+// so it never fragments and never falls back to the heap.
+template <unsigned int SlotSize, unsigned int SlotCount>
+class TArena {
+public:
+    static constexpr unsigned int GetSlotSize() {
+        return SlotSize;
+    }
+
+    static constexpr unsigned int GetSlotCount() {
+        return SlotCount;
+    }
+
+    // nullptr when all slots are taken
+    void* Allocate() {
+        for (unsigned int s = 0; s < SlotCount; ++s) {
+            if (!Used[s]) {
+                Used[s] = true;
+                ++UsedCount;
+                return Slots[s].Data;
+            }
+        }
+        return nullptr;
+    }
+
+    // false when ptr is not a slot of this arena
+    bool Free(void* ptr) {
+        for (unsigned int s = 0; s < SlotCount; ++s) {
+            if (ptr == Slots[s].Data) {
+                if (Used[s]) {
+                    Used[s] = false;
+                    --UsedCount;
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    unsigned int GetUsedCount() const {
+        return UsedCount;
+    }
+
+protected:
+    struct TSlot {
+        alignas(max_align_t) uint8_t Data[SlotSize];
+    };
+
+    TSlot Slots[SlotCount];
+    bool Used[SlotCount] = {};
+    unsigned int UsedCount = 0;
+};
+
+// Where all actors are constructed, each in the smallest slot it fits, or in a larger one when those
+// are taken. Actors keeping palette indices need 2 bytes per pixel at most, actors with pixel storage
+// a canvas worth of memory, crossfades two canvases and compositors one per layer, up to three.
+// Each slot count covers a crossfade between two strategies plus the actor being built for the next
+// switch, as a strategy has at most one actor of every size.
+class TActorArena {
+public:
+    static constexpr unsigned int SMALL_SLOT_SIZE = 2 * NUM_LEDS + 64; // TRandomSmoothBlenderActor
+    static constexpr unsigned int SMALL_SLOTS = 3;
+    static constexpr unsigned int CANVAS_SLOT_SIZE = sizeof(TCanvas) + 128;
+    static constexpr unsigned int CANVAS_SLOTS = 3;
+    static constexpr unsigned int LARGE_SLOT_SIZE = 3 * sizeof(TCanvas) + 128; // TCompositorActor<3>
+    static constexpr unsigned int LARGE_SLOTS = 2;
+
+    static TActorArena& Get() {
+        static TActorArena arena;
+        return arena;
+    }
+
+    // nullptr when the arena is full, the owner releases the actor with a plain delete
+    template <typename ActorType, typename... ArgTypes>
+    ActorType* Create(ArgTypes&&... args) {
+        static_assert(sizeof(ActorType) <= LARGE_SLOT_SIZE, "actor is larger than an arena slot");
+        void* slot = nullptr;
+        if (sizeof(ActorType) <= SMALL_SLOT_SIZE) {
+            slot = Small.Allocate();
+        }
+        if (slot == nullptr && sizeof(ActorType) <= CANVAS_SLOT_SIZE) {
+            slot = Canvas.Allocate();
+        }
+        if (slot == nullptr) {
+            slot = Large.Allocate();
+        }
+        if (slot == nullptr) {
+            return nullptr;
+        }
+        return ::new (slot) ActorType(std::forward<ArgTypes>(args)...);
+    }
+
+    void Free(void* ptr) {
+        if (!Small.Free(ptr) && !Canvas.Free(ptr)) {
+            Large.Free(ptr);
+        }
+    }
+
+    unsigned int GetUsedCount() const {
+        return Small.GetUsedCount() + Canvas.GetUsedCount() + Large.GetUsedCount();
+    }
+
+protected:
+    TArena<SMALL_SLOT_SIZE, SMALL_SLOTS> Small;
+    TArena<CANVAS_SLOT_SIZE, CANVAS_SLOTS> Canvas;
+    TArena<LARGE_SLOT_SIZE, LARGE_SLOTS> Large;
+};
@@ -0,0 +1,220 @@
+#pragma once
+
+#include "platform.h"
+#include "canvas.h"
+#include "sprite.h"
+
+// Animations packed at compile time into a palette and run lengths, so only the packed
+// form ends up in the image and the literal sprites are just the source:
+//   constexpr TAnimation<10, 9> Source = {...};
+//   constexpr auto Packed = PACK_ANIMATION(Source);
+// Each sprite is a list of runs of one palette colour, runs never cross sprites.
+
+struct TPackedRun {
+    uint8_t Length;
+    uint8_t Color; // palette index
+};
+
+template <int Count, int Size, int ColorCount, int RunCount>
+struct TPackedAnimation {
+    uint32_t Palette[ColorCount];
+    uint32_t Ends[Count]; // end times of the sprites from the start of the animation
+    uint16_t SpriteRuns[Count + 1]; // runs of sprite i are SpriteRuns[i]..SpriteRuns[i + 1] - 1
+    TPackedRun Runs[RunCount];
+
+    static constexpr int GetCount() {
+        return Count;
+    }
+
+    static constexpr int GetSize() {
+        return Size;
+    }
+
+    constexpr uint32_t GetDuration(int sprite) const {
+        return Ends[sprite] - (sprite != 0 ? Ends[sprite - 1] : 0);
+    }
+
+    constexpr uint32_t GetEndTime(int sprite) const {
+        return Ends[sprite];
+    }
+
+    constexpr uint32_t GetTotalDuration() const {
+        return Ends[Count - 1];
+    }
+
+    template <unsigned int Length>
+    void Draw(TCanvasOf<Length>& canvas, int sprite, unsigned int position) const {
+        for (unsigned int r = SpriteRuns[sprite]; r < SpriteRuns[sprite + 1]; ++r) {
+            canvas.Fill(position, Palette[Runs[r].Color], Runs[r].Length);
+            position += Runs[r].Length;
+        }
+    }
+};
+
+template <unsigned int... Indices>
+struct TIndexList {};
+
+template <typename First, typename Second>
+struct TJoinIndexLists;
+
+template <unsigned int... First, unsigned int... Second>
+struct TJoinIndexLists<TIndexList<First...>, TIndexList<Second...>> {
+    using Type = TIndexList<First..., (sizeof...(First) + Second)...>;
+};
+
+// 0..N-1, built from halves so that long lists stay within the template depth limit
+template <unsigned int N>
+struct TMakeIndexList {
+    using Type = typename TJoinIndexLists<typename TMakeIndexList<N / 2>::Type, typename TMakeIndexList<N - N / 2>::Type>::Type;
+};
+
+template <>
+struct TMakeIndexList<0> {
+    using Type = TIndexList<>;
+};
+
+template <>
+struct TMakeIndexList<1> {
+    using Type = TIndexList<0>;
+};
+
+// All positions are pixels of the sprites laid end to end. The packer works from tables with one
+// entry per position, each built in one pass over the previous one, so packing costs about
+// n log n steps: prefix counts are log n doubling passes, lookups in them are binary searches,
+// and colours are only compared between the starts of runs.
+template <int Count, int Size>
+struct TAnimationPacker {
+    using TSource = TAnimation<Count, Size>;
+
+    static constexpr unsigned int PIXELS = Count * Size;
+
+    using TPositions = typename TMakeIndexList<PIXELS>::Type;
+
+    struct TTable {
+        unsigned int Values[PIXELS];
+    };
+
+    struct TAnalysis {
+        TTable Starts; // position where run r starts, PIXELS past the last run
+        TTable FirstRuns; // first run with the colour of run r
+        TTable Colors; // palette colours used by runs 0..r
+        unsigned int RunCount;
+        unsigned int ColorCount;
+    };
+
+    static constexpr uint32_t Color(const TSource& a, unsigned int p) {
+        return a.Sprites[p / Size].Image[p % Size];
+    }
+
+    static constexpr bool IsRunStart(const TSource& a, unsigned int p) {
+        return p % Size == 0 || Color(a, p) != Color(a, p - 1);
+    }
+
+    template <unsigned int... P>
+    static constexpr TTable GetRunStartFlags(const TSource& a, TIndexList<P...>) {
+        return {{unsigned(IsRunStart(a, P))...}};
+    }
+
+    template <unsigned int... P>
+    static constexpr TTable AddShifted(const TTable& t, unsigned int shift, TIndexList<P...>) {
+        return {{(P >= shift ? t.Values[P] + t.Values[P - shift] : t.Values[P])...}};
+    }
+
+    // entry p becomes the sum of the entries 0..p
+    static constexpr TTable Sum(const TTable& t, unsigned int shift = 1) {
+        return shift >= PIXELS ? t : Sum(AddShifted(t, shift, TPositions()), shift * 2);
+    }
+
+    // first index in first..last-1 with at least value in the ascending t, last when there is none
+    static constexpr unsigned int LowerBound(const TTable& t, unsigned int value, unsigned int first, unsigned int last) {
+        return first == last ? first
+            : t.Values[(first + last) / 2] >= value
+                ? LowerBound(t, value, first, (first + last) / 2)
+                : LowerBound(t, value, (first + last) / 2 + 1, last);
+    }
+
+    template <unsigned int... R>
+    static constexpr TTable GetStarts(const TTable& runSums, TIndexList<R...>) {
+        return {{LowerBound(runSums, R + 1, 0, PIXELS)...}};
+    }
+
+    // first run in first..last-1 with the colour, last when there is none
+    static constexpr unsigned int FindRun(const TSource& a, const TTable& starts, uint32_t color, unsigned int first, unsigned int last) {
+        return last - first == 1 ? (Color(a, starts.Values[first]) == color ? first : last)
+            : FindRun(a, starts, color, first, (first + last) / 2) != (first + last) / 2
+                ? FindRun(a, starts, color, first, (first + last) / 2)
+                : FindRun(a, starts, color, (first + last) / 2, last);
+    }
+
+    template <unsigned int... R>
+    static constexpr TTable GetFirstRuns(const TSource& a, const TTable& starts, TIndexList<R...>) {
+        return {{(starts.Values[R] < PIXELS ? FindRun(a, starts, Color(a, starts.Values[R]), 0, R + 1) : R)...}};
+    }
+
+    template <unsigned int... R>
+    static constexpr TTable GetNewColorFlags(const TTable& starts, const TTable& firstRuns, TIndexList<R...>) {
+        return {{unsigned(starts.Values[R] < PIXELS && firstRuns.Values[R] == R)...}};
+    }
+
+    static constexpr TAnalysis Analyse(const TSource& a) {
+        return AnalyseRuns(a, GetStarts(Sum(GetRunStartFlags(a, TPositions())), TPositions()));
+    }
+
+    static constexpr TAnalysis AnalyseRuns(const TSource& a, const TTable& starts) {
+        return AnalyseColors(starts, GetFirstRuns(a, starts, TPositions()));
+    }
+
+    static constexpr TAnalysis AnalyseColors(const TTable& starts, const TTable& firstRuns) {
+        return AnalyseCounts(starts, firstRuns, Sum(GetNewColorFlags(starts, firstRuns, TPositions())));
+    }
+
+    static constexpr TAnalysis AnalyseCounts(const TTable& starts, const TTable& firstRuns, const TTable& colors) {
+        return {starts, firstRuns, colors, LowerBound(starts, PIXELS, 0, PIXELS), colors.Values[PIXELS - 1]};
+    }
+
+    static constexpr uint32_t GetPaletteColor(const TSource& a, const TAnalysis& analysis, unsigned int k) {
+        return Color(a, analysis.Starts.Values[LowerBound(analysis.Colors, k + 1, 0, PIXELS)]);
+    }
+
+    static constexpr TPackedRun GetRun(const TAnalysis& analysis, unsigned int r) {
+        return {
+            uint8_t((r + 1 < PIXELS ? analysis.Starts.Values[r + 1] : PIXELS) - analysis.Starts.Values[r]),
+            uint8_t(analysis.Colors.Values[analysis.FirstRuns.Values[r]] - 1)
+        };
+    }
+
+    template <int ColorCount, int RunCount, unsigned int... C, unsigned int... S, unsigned int... R>
+    static constexpr TPackedAnimation<Count, Size, ColorCount, RunCount> Pack(
+            const TSource& a, const TAnalysis& analysis, TIndexList<C...>, TIndexList<S...>, TIndexList<R...>) {
+        return {
+            {GetPaletteColor(a, analysis, C)...},
+            {a.GetEndTime(S)...},
+            {uint16_t(LowerBound(analysis.Starts, S * Size, 0, PIXELS))..., uint16_t(RunCount)},
+            {GetRun(analysis, R)...}
+        };
+    }
+};
+
+template <int ColorCount, int RunCount, int Count, int Size>
+constexpr TPackedAnimation<Count, Size, ColorCount, RunCount> PackAnimation(const TAnimation<Count, Size>& source) {
+    static_assert(Size <= 255, "sprite is too long for a run length byte");
+    static_assert(ColorCount <= 256, "too many colours for a palette index byte");
+    return TAnimationPacker<Count, Size>::template Pack<ColorCount, RunCount>(
+        source,
+        TAnimationPacker<Count, Size>::Analyse(source),
+        typename TMakeIndexList<ColorCount>::Type(),
+        typename TMakeIndexList<Count>::Type(),
+        typename TMakeIndexList<RunCount>::Type());
+}
+
+template <int Count, int Size>
+constexpr unsigned int GetPackedColorCount(const TAnimation<Count, Size>& source) {
+    return TAnimationPacker<Count, Size>::Analyse(source).ColorCount;
+}
+
+template <int Count, int Size>
+constexpr unsigned int GetPackedRunCount(const TAnimation<Count, Size>& source) {
+    return TAnimationPacker<Count, Size>::Analyse(source).RunCount;
+}
+
+#define PACK_ANIMATION(source) PackAnimation<GetPackedColorCount(source), GetPackedRunCount(source)>(source)
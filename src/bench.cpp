@@ -0,0 +1,858 @@
+#if !defined(ARDUINO) && defined(LED300_BENCH)
+
+#include <chrono>
+#include "platform.h"
+#include "actors.h"
+#include "asset.h"
+#include "commands.h"
+#include "compositor.h"
+#include "crossfade.h"
+#include "encoder.h"
+#include "output.h"
+#include "stream.h"
+
+static volatile uint32_t Sink;
+static unsigned int FailedChecks = 0;
+
+// counts a check that didn't pass, so that the bench exits with an error, and marks its line
+static const char* Check(bool passed) {
+    FailedChecks += !passed;
+    return passed ? "" : " FAILED";
+}
+
+template <typename Func>
+static void Bench(const char* name, unsigned int pixels, Func func) {
+    using namespace std::chrono;
+    func();
+    unsigned long frames = 0;
+    auto start = steady_clock::now();
+    nanoseconds elapsed;
+    do {
+        for (int i = 0; i < 100; ++i) {
+            func();
+        }
+        frames += 100;
+        elapsed = steady_clock::now() - start;
+    } while (elapsed < milliseconds(200));
+    double frame = double(elapsed.count()) / frames;
+    printf("%-48s %10.1f ns/frame %8.2f ns/pixel\n", name, frame, frame / pixels);
+}
+
+// the float implementation MergeColors had before the fixed point one, kept as the reference
+static uint32_t FloatMergeColors(uint32_t a, uint32_t b, float amount_b) {
+    float amount_a = 1 - min(amount_b, 1);
+    TColorRGB _a;
+    TColorRGB _b;
+    TColorRGB _r;
+
+    _a.Value = a;
+    _b.Value = b;
+    _r.Value = 0;
+    _r.R = min(round(_a.R * amount_a) + round(_b.R * amount_b), 255);
+    _r.G = min(round(_a.G * amount_a) + round(_b.G * amount_b), 255);
+    _r.B = min(round(_a.B * amount_a) + round(_b.B * amount_b), 255);
+    return _r.Value;
+}
+
+// the bitfield implementation MaskPattern had before TSwar, truncating rather than rounding
+template <typename PatternType>
+static void BitfieldMaskPattern(const PatternType& patternSource, PatternType& patternTarget, uint32_t patternMask) {
+    TColorRGB mask;
+    mask.Value = patternMask;
+    for (unsigned int i = 0; i < countof(patternSource); ++i) {
+        TColorRGB target;
+        TColorRGB source;
+        source.Value = patternSource[i];
+        target.R = source.R * mask.R / 255;
+        target.G = source.G * mask.G / 255;
+        target.B = source.B * mask.B / 255;
+        patternTarget[i] = target.Value;
+    }
+}
+
+// TAnimationPlay before the cursor, walks the durations from the first sprite on every call
+template <typename AnimationType>
+static int LinearCurrentSprite(const AnimationType& animation, uint32_t startTime, uint32_t time) {
+    uint32_t delta = time - startTime;
+    for (int i = 0; i < animation.GetCount(); ++i) {
+        if (delta < animation.GetDuration(i)) {
+            return i;
+        }
+        delta -= animation.GetDuration(i);
+    }
+    return -1;
+}
+
+// the single pixel decay the splashes used before the span TSwar::Sub, takes amount off every channel
+static uint32_t DecayColor(uint32_t color, uint32_t amount) {
+    return TSwar::Sub(color, min(amount, 255u) * 0x010101);
+}
+
+// TProportionalColorsActor::Draw before TGradient, a division and a merge per pixel
+template <typename ColorsType>
+static void MergeProportionalColors(const ColorsType& colors, uint32_t* pixels, unsigned int count) {
+    unsigned int steps = countof(colors) - 1;
+    for (unsigned int i = 0; i < count; ++i) {
+        unsigned int colorIndex = i * steps / count;
+        pixels[i] = TColorSmoother::MergeColors(colors[colorIndex], colors[colorIndex + 1], TColorSmoother::GetMergeAmount(i * steps - colorIndex * count, count));
+    }
+}
+
+static void NoCommand(TCommandLine&) {
+}
+
+// same shape as the table in main.cpp
+static const TCommand BenchCommands[] = {
+    {"SET", 1, NoCommand, false},
+    {"BLEND", 1, NoCommand, false},
+    {"BRIGHTNESS", 1, NoCommand, false},
+    {"FADE", 1, NoCommand, false},
+    {"FPS", 1, NoCommand, false},
+    {"LOCK", 0, NoCommand, false},
+    {"UNLOCK", 0, NoCommand, false},
+    {"STOP", 0, NoCommand, false},
+    {"PRINT", 0, NoCommand, false},
+    {"PING", 0, NoCommand, true},
+};
+
+// a short burst, stands in for the animation in main.cpp
+constexpr TAnimation<6, 9> BenchAnimation = {
+    {
+        {8, {0x000000, 0x000000, 0x000000, 0x000000, 0xFFFFFF, 0x000000, 0x000000, 0x000000, 0x000000}},
+        {8, {0x000000, 0x000000, 0x000000, 0xC0C0C0, 0xFFFFFF, 0xC0C0C0, 0x000000, 0x000000, 0x000000}},
+        {5, {0x000000, 0x000000, 0xC0C0C0, 0x808080, 0x404040, 0x808080, 0xC0C0C0, 0x000000, 0x000000}},
+        {8, {0x000000, 0x404040, 0x202020, 0x101010, 0x080808, 0x101010, 0x202020, 0x404040, 0x000000}},
+        {8, {0x101010, 0x080808, 0x040404, 0x040004, 0x040004, 0x000004, 0x040404, 0x080808, 0x101010}},
+        {8, {0x000000, 0x000000, 0x000000, 0x000000, 0x000000, 0x000000, 0x000000, 0x000000, 0x000000}}
+    }
+};
+constexpr auto PackedBenchAnimation = PACK_ANIMATION(BenchAnimation);
+
+// 30 sprites of 30 pixels, a ring of grey levels widening over sparse coloured dots, enough pixels
+// to show the packer keeps within the compiler's constexpr limits
+constexpr uint32_t LargePixel(unsigned int sprite, unsigned int i) {
+    return (i * 7 + sprite * 3) % 11 == 0 ? 0x010203 * ((i + sprite) % 5 + 1)
+        : (i > 15 ? i - 15 : 15 - i) <= sprite / 2 ? 0x101010 * (sprite / 4)
+        : 0x000000;
+}
+
+template <unsigned int... I>
+constexpr TSprite<30> LargeSprite(unsigned int sprite, TIndexList<I...>) {
+    return {uint32_t(sprite % 3 * 4), {LargePixel(sprite, I)...}};
+}
+
+template <unsigned int... S>
+constexpr TAnimation<30, 30> MakeLargeAnimation(TIndexList<S...>) {
+    return {{LargeSprite(S, TMakeIndexList<30>::Type())...}};
+}
+
+constexpr TAnimation<30, 30> LargeAnimation = MakeLargeAnimation(TMakeIndexList<30>::Type());
+constexpr auto PackedLargeAnimation = PACK_ANIMATION(LargeAnimation);
+
+// a full Move() per call: time moves on by the actor's period and the actor redraws even when
+// it has nothing new, so every call costs a step and a Draw()
+template <typename ActorType>
+static void BenchMove(const char* name, ActorType&& actor) {
+    TCanvas canvas;
+    Bench(name, NUM_LEDS, [&]() {
+        Clock.Advance(max(actor.Period, 1ul) * 1000);
+        actor.Invalidate();
+        actor.Move(canvas, millis());
+    });
+}
+
+static int ChannelDeviation(uint32_t a, uint32_t b) {
+    int deviation = 0;
+    for (int shift = 0; shift < 24; shift += 8) {
+        int d = abs(int((a >> shift) & 0xFF) - int((b >> shift) & 0xFF));
+        deviation = max(deviation, d);
+    }
+    return deviation;
+}
+
+static void CheckMergeColors() {
+    // denominators of the blend steps used by the actors
+    const uint32_t totals[] = {10, 20, 50, 249, NUM_LEDS};
+    int worst = 0;
+    for (uint32_t total : totals) {
+        for (uint32_t part = 0; part <= total; ++part) {
+            uint32_t amount = TColorSmoother::GetMergeAmount(part, total);
+            float trans = float(part) / total;
+            for (uint32_t a = 0; a < 256; ++a) {
+                for (uint32_t b = 0; b < 256; ++b) {
+                    uint32_t ca = a * 0x010101;
+                    uint32_t cb = (b << 16) | ((255 - b) << 8) | b;
+                    worst = max(worst, ChannelDeviation(FloatMergeColors(ca, cb, trans), TColorSmoother::MergeColors(ca, cb, amount)));
+                }
+            }
+        }
+    }
+    printf("MergeColors max deviation from float path: %d%s\n", worst, Check(worst <= 1));
+}
+
+// every pair of channel values against plain per channel arithmetic, G runs the other way
+// than R and B so a carry between channels shows up
+static void CheckSwar() {
+    unsigned int errors = 0;
+    auto check = [&](const char* name, uint32_t a, uint32_t b, uint32_t got, uint32_t (*channel)(uint32_t, uint32_t)) {
+        uint32_t expected = 0;
+        for (int shift = 0; shift < 24; shift += 8) {
+            expected |= channel((a >> shift) & 0xFF, (b >> shift) & 0xFF) << shift;
+        }
+        if (got != expected && errors++ < 10) {
+            printf("TSwar::%s(%06X, %06X) = %06X, expected %06X\n", name, a, b, got, expected);
+        }
+    };
+    for (uint32_t a = 0; a < 256; ++a) {
+        uint32_t ca = a * 0x010101;
+        for (uint32_t b = 0; b < 256; ++b) {
+            uint32_t cb = (b << 16) | ((255 - b) << 8) | b;
+            check("Add", ca, cb, TSwar::Add(ca, cb), [](uint32_t x, uint32_t y) { return min(x + y, 255u); });
+            check("Sub", ca, cb, TSwar::Sub(ca, cb), [](uint32_t x, uint32_t y) { return x > y ? x - y : 0; });
+            check("Max", ca, cb, TSwar::Max(ca, cb), [](uint32_t x, uint32_t y) { return max(x, y); });
+            check("Multiply", ca, cb, TSwar::Multiply(ca, cb), [](uint32_t x, uint32_t y) { return (x * y * 2 + 255) / 510; });
+        }
+        for (uint32_t scale = 0; scale <= 256; ++scale) {
+            uint32_t cb = (a << 16) | ((255 - a) << 8) | a;
+            uint32_t expected = (a * scale >> 8) * 0x010001 | ((255 - a) * scale >> 8) << 8;
+            if (TSwar::Scale(cb, scale) != expected && errors++ < 10) {
+                printf("TSwar::Scale(%06X, %u) = %06X, expected %06X\n", cb, scale, TSwar::Scale(cb, scale), expected);
+            }
+        }
+    }
+    printf("TSwar mismatches against per channel arithmetic: %u%s\n", errors, Check(errors == 0));
+}
+
+// evenly spaced stops against the per pixel merge, and a gradient scrolled by a whole number of
+// pixels against the same gradient rotated
+static void CheckGradient() {
+    const uint32_t colors[] = {0xFF0000, 0xFF7F00, 0xFFFF00, 0x00FF00, 0x0000FF, 0x2E2B5F, 0x8B00FF};
+    uint32_t expected[NUM_LEDS];
+    uint32_t pixels[NUM_LEDS];
+    TGradient gradient;
+    gradient.SetColors(colors);
+    MergeProportionalColors(colors, expected, NUM_LEDS);
+    gradient.Render(pixels, NUM_LEDS);
+    int worst = 0;
+    for (unsigned int i = 0; i < NUM_LEDS; ++i) {
+        worst = max(worst, ChannelDeviation(expected[i], pixels[i]));
+    }
+    printf("TGradient max deviation from per pixel merge: %d%s\n", worst, Check(worst <= 1));
+
+    const TGradientStop stops[] = {{0x1000, 0x000000}, {0x1100, 0xFFFFFF}, {0x8000, 0x00FF00}, {0xC000, 0xFF00FF}, {0xC010, 0x0000FF}};
+    gradient.SetStops(stops, countof(stops));
+    // 256 pixels, so that every whole pixel is a phase that works out exactly
+    gradient.Render(expected, 256);
+    unsigned int errors = 0;
+    for (unsigned int shift = 0; shift < 256; ++shift) {
+        gradient.Render(pixels, 256, shift * TGradient::END / 256);
+        for (unsigned int i = 0; i < 256; ++i) {
+            errors += expected[(i + shift) % 256] != pixels[i];
+        }
+    }
+    printf("TGradient scrolled pixels off the rotated ones: %u%s\n", errors, Check(errors == 0));
+}
+
+// every sprite of the packed animation has to draw the same pixels and last as long as the source
+template <typename SourceType, typename PackedType>
+static void CheckPackedAnimation(const char* name, const SourceType& source, const PackedType& packed) {
+    TCanvas expected;
+    TCanvas canvas;
+    unsigned int errors = 0;
+    for (int sprite = 0; sprite < source.GetCount(); ++sprite) {
+        expected.Fill(0, 0, NUM_LEDS);
+        canvas.Fill(0, 0, NUM_LEDS);
+        source.Draw(expected, sprite, 1);
+        packed.Draw(canvas, sprite, 1);
+        for (unsigned int i = 0; i < NUM_LEDS; ++i) {
+            errors += expected.Get(i) != canvas.Get(i);
+        }
+        errors += source.GetDuration(sprite) != packed.GetDuration(sprite);
+    }
+    printf("%-48s %u pixels off the source, %u bytes for %u%s\n", name, errors, unsigned(sizeof(packed)), unsigned(sizeof(source)), Check(errors == 0));
+}
+
+// sprites with no duration at the start, in the middle and at the end, which neither walk shows
+constexpr TAnimation<7, 2> ZeroLengthAnimation = {
+    {
+        {0, {0x000001, 0x000001}},
+        {3, {0x000002, 0x000002}},
+        {0, {0x000003, 0x000003}},
+        {0, {0x000004, 0x000004}},
+        {1, {0x000005, 0x000005}},
+        {4, {0x000006, 0x000006}},
+        {0, {0x000007, 0x000007}}
+    }
+};
+constexpr auto PackedZeroLengthAnimation = PACK_ANIMATION(ZeroLengthAnimation);
+
+// the play's cursor against the linear walk, over times going forward by 0..9 ms and restarts
+// at random frames
+template <typename AnimationType>
+static void CheckAnimationPlay(const char* name, const AnimationType& animation) {
+    TAnimationPlay play;
+    uint32_t startTime = 1000;
+    uint32_t time = startTime;
+    play.Start(startTime);
+    unsigned int errors = 0;
+    for (unsigned int i = 0; i < 100000; ++i) {
+        time += random(10);
+        if (random(20) == 0) {
+            startTime = time - random(3);
+            play.Start(startTime);
+        }
+        errors += play.GetCurrentSprite(animation, time) != LinearCurrentSprite(animation, startTime, time);
+    }
+    printf("%-48s %u sprites off the linear walk%s\n", name, errors, Check(errors == 0));
+}
+
+// MakeRandom from a result that's among the choices and from one that isn't: result never comes
+// back, and every other choice comes up within 5% of an even share
+static void CheckMakeRandom() {
+    const uint32_t choices[] = {0xFF0000, 0x00FF00, 0x0000FF, 0xFFFF00, 0x00FFFF};
+    const uint32_t starts[] = {choices[2], 0x123456};
+    const unsigned int draws = 100000;
+    bool even = true;
+    for (uint32_t start : starts) {
+        unsigned int counts[countof(choices)] = {};
+        for (unsigned int n = 0; n < draws; ++n) {
+            uint32_t result = start;
+            MakeRandom(result, choices);
+            for (unsigned int i = 0; i < countof(choices); ++i) {
+                counts[i] += result == choices[i];
+            }
+        }
+        unsigned int share = draws / (start == choices[2] ? countof(choices) - 1 : countof(choices));
+        for (unsigned int i = 0; i < countof(choices); ++i) {
+            if (choices[i] == start) {
+                even &= counts[i] == 0;
+            } else {
+                even &= counts[i] > share * 95 / 100 && counts[i] < share * 105 / 100;
+            }
+        }
+    }
+    printf("MakeRandom draws even over the other choices: %s%s\n", even ? "yes" : "no", Check(even));
+}
+
+// an actor run for about a second from the same seed at frame periods of 1, 9 and 33 ms has to end
+// up with the same pixels, as the steps missed between frames are made up for
+template <typename ActorType, typename... Args>
+static void CheckFrameRates(const char* name, const Args&... args) {
+    const uint32_t framePeriods[] = {1, 9, 33}; // ms, 990 ms is a whole number of each
+    TCanvas first;
+    unsigned int differences = 0;
+    for (uint32_t framePeriod : framePeriods) {
+        TRandom::Get().Seed(1);
+        ActorType actor(args...);
+        TCanvas canvas;
+        uint32_t start = millis();
+        for (uint32_t time = 0; time <= 990; time += framePeriod) {
+            actor.Move(canvas, start + time);
+        }
+        Clock.Advance(1000000);
+        if (framePeriod == framePeriods[0]) {
+            first = canvas;
+            continue;
+        }
+        for (unsigned int i = 0; i < NUM_LEDS; ++i) {
+            differences += first.Get(i) != canvas.Get(i);
+        }
+    }
+    printf("%-48s %u pixels differ between frame rates%s\n", name, differences, Check(differences == 0));
+}
+
+// an actor moved every ms for about ten seconds: no frame inside the idle time it gave before may
+// change the canvas, otherwise the scheduler would have slept through that change
+template <typename ActorType, typename... Args>
+static void CheckIdleTime(const char* name, const Args&... args) {
+    TRandom::Get().Seed(1);
+    ActorType actor(args...);
+    TCanvas canvas;
+    uint32_t start = millis();
+    uint32_t wake = start;
+    unsigned int missed = 0;
+    unsigned int idle = 0;
+    for (uint32_t time = start; time != start + 10000; ++time) {
+        bool changed = actor.Move(canvas, time);
+        missed += changed && int32_t(time - wake) < 0;
+        uint32_t idleTime = actor.GetIdleTime(time);
+        if (int32_t(time - wake) >= 0) {
+            wake = time + min(idleTime, 10000u);
+        }
+        idle += idleTime != 0;
+    }
+    Clock.Advance(10000000);
+    printf("%-48s %u changes inside the idle time, idle %u of 10000 ms%s\n", name, missed, idle, Check(missed == 0 && idle != 0));
+}
+
+// a grey ramp at brightness 50 shown for 256 frames, first as it is by default: every level has
+// to stay steady at its rounded table level, no level but 0 may be black and nothing asks for
+// more frames. Then dithered: every level has to add up to its 8.8 table level exactly, the
+// levels the patterns fade through (0x04, 0x08 .. 0x80) have to stay apart once they are above
+// the steady lowest step, and whole steps mustn't keep frames coming.
+static void CheckOutputLevels(TStripSet& strips, TOutputStage& output) {
+    output.SetBrightness(50);
+    TCanvas canvas;
+    for (unsigned int i = 0; i < 256; ++i) {
+        canvas.Set(i, i * 0x010101);
+    }
+    auto level = [&](unsigned int i) {
+        return strips[i / STRIP_LENGTH].getPixels()[i % STRIP_LENGTH * 3 + TOutputStage::G_OFFSET];
+    };
+    unsigned int wrong = 0;
+    unsigned int black = 0;
+    unsigned int refreshing = 0;
+    for (unsigned int frame = 0; frame < 256; ++frame) {
+        output.Show(canvas);
+        for (unsigned int i = 1; i < 256; ++i) {
+            wrong += level(i) != (output.GetLevel(i) + 0x80u) >> 8;
+            black += level(i) == 0;
+        }
+        refreshing += output.IsDithering();
+    }
+    printf("Output levels at brightness 50: %u off their rounded table level, %u black, %u frames refreshing%s\n",
+        wrong, black, refreshing, Check(wrong == 0 && black == 0 && refreshing == 0));
+
+    output.SetDither(true);
+    uint32_t sums[256] = {};
+    for (unsigned int frame = 0; frame < 256; ++frame) {
+        output.Show(canvas);
+        for (unsigned int i = 0; i < 256; ++i) {
+            sums[i] += level(i);
+        }
+    }
+    wrong = 0;
+    black = 0;
+    unsigned int merged = 0;
+    for (unsigned int i = 1; i < 256; ++i) {
+        wrong += sums[i] != output.GetLevel(i);
+        black += sums[i] == 0;
+    }
+    for (unsigned int i = 0x04; i < 0x80; i <<= 1) {
+        merged += output.GetLevel(i) > 0x100 && sums[i] >= sums[i << 1];
+    }
+    canvas.Fill(0, 0xFF00FF, NUM_LEDS);
+    output.Show(canvas);
+    refreshing = output.IsDithering();
+    printf("Output levels dithered: %u off their table level, %u black, %u powers of two merged, %u refreshing on whole steps, 0x04 .. 0x80 average",
+        wrong, black, merged, refreshing);
+    for (unsigned int i = 0x04; i <= 0x80; i <<= 1) {
+        printf(" %.3f", sums[i] / 256.0);
+    }
+    printf("%s\n", Check(wrong == 0 && black == 0 && merged == 0 && refreshing == 0));
+    output.SetDither(false);
+}
+
+// streams the changed frames of an actor through the encoder and the receiver, checking every
+// frame arrives intact, and reports the bytes per frame on the link
+template <typename ActorType>
+static void BenchEncoder(const char* name, ActorType&& actor, unsigned int frames) {
+    static TFrameReceiver receiver;
+    TCanvas canvas;
+    TFrameEncoder encoder;
+    std::vector<uint8_t> stream;
+    uint8_t rgb[TFrameReceiver::FRAME_SIZE];
+    unsigned long bytes = 0;
+    unsigned int sent = 0;
+    unsigned int broken = 0;
+    for (unsigned int n = 0; n < frames; ++n) {
+        Clock.Advance(1000000 / FRAME_RATE);
+        if (!actor.Move(canvas, millis())) {
+            continue;
+        }
+        for (unsigned int i = 0; i < NUM_LEDS; ++i) {
+            uint32_t color = canvas.Get(i);
+            rgb[i * 3] = color >> 16;
+            rgb[i * 3 + 1] = color >> 8;
+            rgb[i * 3 + 2] = color;
+        }
+        stream.clear();
+        encoder.Encode(rgb, stream);
+        TSimulatedSerial port(nullptr);
+        port.Feed(stream.data(), stream.size());
+        uint32_t received = receiver.Frames;
+        for (int k = 0; k < 100 && port.available(); ++k) {
+            receiver.Read(port);
+        }
+        broken += receiver.Frames != received + 1 || memcmp(receiver.GetFrame(), rgb, sizeof(rgb)) != 0;
+        bytes += stream.size();
+        ++sent;
+    }
+    printf("%-48s %10.1f bytes/frame %8u frames%s\n", name, sent ? double(bytes) / sent : 0.0, sent, Check(broken == 0));
+}
+
+int main() {
+    const uint8_t pins[] = {STRIP_PINS};
+    TStripSet strips(pins, STRIP_TYPE);
+    strips.Begin();
+    strips[0].setBrightness(50);
+    TCanvas canvas;
+    TOutputStage output(strips);
+    output.SetBrightness(50);
+    uint32_t colors[] = {0xFF0000, 0x00FF00, 0x0000FF, 0xFFFF00, 0x00FFFF, 0xFF00FF, 0xFFC0CB, 0xFFA500};
+    uint32_t a[NUM_LEDS];
+    uint32_t b[NUM_LEDS];
+    TPixelRing<NUM_LEDS> ring;
+    for (unsigned int i = 0; i < NUM_LEDS; ++i) {
+        a[i] = random(0x1000000);
+        b[i] = random(0x1000000);
+        ring[i] = a[i];
+    }
+
+    CheckMergeColors();
+    CheckSwar();
+    CheckGradient();
+    CheckOutputLevels(strips, output);
+    CheckPackedAnimation("PACK_ANIMATION 6 x 9", BenchAnimation, PackedBenchAnimation);
+    CheckPackedAnimation("PACK_ANIMATION 30 x 30", LargeAnimation, PackedLargeAnimation);
+    CheckAnimationPlay("TAnimationPlay zero length sprites", ZeroLengthAnimation);
+    CheckAnimationPlay("TAnimationPlay zero length sprites packed", PackedZeroLengthAnimation);
+    CheckAnimationPlay("TAnimationPlay packed", PackedBenchAnimation);
+    CheckMakeRandom();
+
+    const uint32_t checkPattern[] = {0x000000, 0x101010, 0x404040, 0xFFFFFF, 0x404040, 0x101010, 0x000000};
+    const uint32_t checkColors[] = {0xFF0000, 0x00FF00, 0x0000FF, 0xFFFF00};
+    CheckFrameRates<TPatternActor<decltype(checkPattern)>>("TPatternActor", checkPattern, 1, true, 40);
+    CheckFrameRates<TSmoothPatternActor<decltype(checkPattern)>>("TSmoothPatternActor", checkPattern, true);
+    CheckFrameRates<TChaoticPatternMovementActor<decltype(checkPattern)>>("TChaoticPatternMovementActor", checkPattern);
+    CheckFrameRates<TChaoticPatternMovementWithRandomTrailActor<decltype(checkPattern)>>("TChaoticPatternMovementWithRandomTrailActor", checkPattern);
+    CheckFrameRates<TRandomShifterActor<>>("TRandomShifterActor");
+    CheckFrameRates<TRandomSelectorSmoothShifterActor<decltype(checkColors)>>("TRandomSelectorSmoothShifterActor", checkColors);
+    CheckFrameRates<TDecayingSplashesActor<decltype(checkColors)>>("TDecayingSplashesActor", 1, 5, checkColors);
+    CheckFrameRates<TShiftRandomColorsActor<decltype(checkColors)>>("TShiftRandomColorsActor", checkColors);
+    CheckFrameRates<TProportionalColorsActor<decltype(checkColors)>>("TProportionalColorsActor scrolling", checkColors, 22);
+    CheckFrameRates<TAnimationActor<decltype(BenchAnimation), 10>>("TAnimationActor", BenchAnimation);
+    CheckIdleTime<TAnimationActor<decltype(PackedBenchAnimation), 10>>("TAnimationActor", PackedBenchAnimation);
+    CheckIdleTime<TPatternActor<decltype(checkPattern)>>("TPatternActor", checkPattern, 1, true, 40);
+
+    uint32_t step = 0;
+    Bench("MergeColors float x NUM_LEDS", NUM_LEDS, [&]() {
+        float trans = float(++step % 50) / 50;
+        uint32_t sum = 0;
+        for (unsigned int i = 0; i < NUM_LEDS; ++i) {
+            sum += FloatMergeColors(a[i], b[i], trans);
+        }
+        Sink = sum;
+    });
+    Bench("MergeColors fixed x NUM_LEDS", NUM_LEDS, [&]() {
+        uint32_t amount = TColorSmoother::GetMergeAmount(++step % 50, 50);
+        uint32_t sum = 0;
+        for (unsigned int i = 0; i < NUM_LEDS; ++i) {
+            sum += TColorSmoother::MergeColors(a[i], b[i], amount);
+        }
+        Sink = sum;
+    });
+    Bench("setPixelColor x NUM_LEDS", NUM_LEDS, [&]() {
+        for (unsigned int i = 0; i < NUM_LEDS; ++i) {
+            strips[i / STRIP_LENGTH].setPixelColor(i % STRIP_LENGTH, a[i]);
+        }
+    });
+    Bench("TCanvas::Write + TOutputStage::Show", NUM_LEDS, [&]() {
+        canvas.Write(0, a, NUM_LEDS);
+        output.Show(canvas);
+    });
+    Bench("TOutputStage::Show ramping", NUM_LEDS, [&]() {
+        Clock.Advance(1000);
+        if (!output.IsRamping()) {
+            output.SetBrightness(output.GetBrightness() == 50 ? 200 : 50, 100);
+        }
+        output.Show(canvas);
+    });
+    Bench("SmoothApply", NUM_LEDS, [&]() {
+        ring.RotateUp();
+        TColorSmoother::SmoothApply(canvas, ring, TColorSmoother::GetMergeAmount(++step % 20, 20));
+    });
+
+    TPixelRing<NUM_LEDS, uint8_t> indexRing;
+    for (unsigned int i = 0; i < NUM_LEDS; ++i) {
+        indexRing[i] = GetRandomIndex(colors);
+    }
+    Bench("SmoothApply palette", NUM_LEDS, [&]() {
+        indexRing.RotateUp();
+        TColorSmoother::SmoothApply(canvas, indexRing, colors, TColorSmoother::GetMergeAmount(++step % 20, 20));
+    });
+    uint32_t pattern[20];
+    uint32_t patternCopy[countof(pattern)];
+    for (uint32_t& color : pattern) {
+        color = random(0x1000000);
+    }
+    Bench("MaskPattern bitfields x 20", countof(pattern), [&]() {
+        BitfieldMaskPattern(pattern, patternCopy, colors[++step % countof(colors)]);
+        Sink = patternCopy[0];
+    });
+    Bench("MaskPattern x 20", countof(pattern), [&]() {
+        TColorSmoother::MaskPattern(pattern, patternCopy, colors[++step % countof(colors)]);
+        Sink = patternCopy[0];
+    });
+    Bench("DecayColor x NUM_LEDS", NUM_LEDS, [&]() {
+        uint32_t amount = ++step % 256;
+        uint32_t sum = 0;
+        for (unsigned int i = 0; i < NUM_LEDS; ++i) {
+            sum += DecayColor(a[i], amount);
+        }
+        Sink = sum;
+    });
+    uint32_t spanPixels[NUM_LEDS];
+    Bench("TSwar::Add span", NUM_LEDS, [&]() {
+        memcpy(spanPixels, a, sizeof(spanPixels));
+        TSwar::Add(spanPixels, b, NUM_LEDS);
+        Sink = spanPixels[step++ % NUM_LEDS];
+    });
+    Bench("TSwar::Sub span", NUM_LEDS, [&]() {
+        memcpy(spanPixels, a, sizeof(spanPixels));
+        TSwar::Sub(spanPixels, b, NUM_LEDS);
+        Sink = spanPixels[step++ % NUM_LEDS];
+    });
+    Bench("TSwar::Max span", NUM_LEDS, [&]() {
+        memcpy(spanPixels, a, sizeof(spanPixels));
+        TSwar::Max(spanPixels, b, NUM_LEDS);
+        Sink = spanPixels[step++ % NUM_LEDS];
+    });
+    Bench("TSwar::Scale span", NUM_LEDS, [&]() {
+        memcpy(spanPixels, a, sizeof(spanPixels));
+        TSwar::Scale(spanPixels, ++step % 257, NUM_LEDS);
+        Sink = spanPixels[step % NUM_LEDS];
+    });
+    Bench("TSwar::Lerp span", NUM_LEDS, [&]() {
+        TSwar::Lerp(spanPixels, a, b, ++step % 257, NUM_LEDS);
+        Sink = spanPixels[step % NUM_LEDS];
+    });
+    Bench("TSwar::Multiply span", NUM_LEDS, [&]() {
+        memcpy(spanPixels, a, sizeof(spanPixels));
+        TSwar::Multiply(spanPixels, b, NUM_LEDS);
+        Sink = spanPixels[step++ % NUM_LEDS];
+    });
+    Bench("proportional colours per pixel merge", NUM_LEDS, [&]() {
+        MergeProportionalColors(colors, spanPixels, NUM_LEDS);
+        Sink = spanPixels[step++ % NUM_LEDS];
+    });
+    TGradient gradient;
+    gradient.SetColors(colors);
+    Bench("TGradient::Render proportional colours", NUM_LEDS, [&]() {
+        gradient.Render(spanPixels, NUM_LEDS);
+        Sink = spanPixels[step++ % NUM_LEDS];
+    });
+    const TGradientStop gradientStops[] = {{0x1000, 0x000000}, {0x1100, 0xFFFFFF}, {0x8000, 0x00FF00}, {0xC000, 0xFF00FF}, {0xC010, 0x0000FF}};
+    gradient.SetStops(gradientStops, countof(gradientStops));
+    Bench("TGradient::Render 5 stops scrolled", NUM_LEDS, [&]() {
+        gradient.Render(spanPixels, NUM_LEDS, step += 97);
+        Sink = spanPixels[step % NUM_LEDS];
+    });
+    Bench("random() x NUM_LEDS", NUM_LEDS, [&]() {
+        uint32_t sum = 0;
+        for (unsigned int i = 0; i < NUM_LEDS; ++i) {
+            sum += random(NUM_LEDS);
+        }
+        Sink = sum;
+    });
+    Bench("TRandom::Below x NUM_LEDS", NUM_LEDS, [&]() {
+        uint32_t sum = 0;
+        for (unsigned int i = 0; i < NUM_LEDS; ++i) {
+            sum += RandomBelow(NUM_LEDS);
+        }
+        Sink = sum;
+    });
+    Bench("TRandom::FillColors x NUM_LEDS", NUM_LEDS, [&]() {
+        TRandom::Get().FillColors(a, NUM_LEDS);
+    });
+    Bench("GetRandom x NUM_LEDS", NUM_LEDS, [&]() {
+        uint32_t sum = 0;
+        for (unsigned int i = 0; i < NUM_LEDS; ++i) {
+            sum += GetRandom(colors);
+        }
+        Sink = sum;
+    });
+    Bench("MakeRandom x NUM_LEDS", NUM_LEDS, [&]() {
+        uint32_t color = colors[0];
+        for (unsigned int i = 0; i < NUM_LEDS; ++i) {
+            MakeRandom(color, colors);
+        }
+        Sink = color;
+    });
+
+    // ten plays of the packed animation, as in the firmware, a few ms apart, stepped on by one frame
+    // per call and restarted once over
+    TAnimationPlay plays[10];
+    uint32_t startTimes[countof(plays)] = {};
+    uint32_t animationTime = 0;
+    Bench("TAnimationPlay::GetCurrentSprite x 10", 10, [&]() {
+        animationTime += 1000 / FRAME_RATE;
+        int sum = 0;
+        for (unsigned int p = 0; p < countof(plays); ++p) {
+            int sprite = plays[p].GetCurrentSprite(PackedBenchAnimation, animationTime);
+            if (sprite < 0) {
+                startTimes[p] = animationTime - p * 5;
+                plays[p].Start(startTimes[p]);
+            }
+            sum += sprite;
+        }
+        Sink = sum;
+    });
+    animationTime = 0;
+    Bench("TAnimationPlay linear walk x 10", 10, [&]() {
+        animationTime += 1000 / FRAME_RATE;
+        int sum = 0;
+        for (unsigned int p = 0; p < countof(plays); ++p) {
+            int sprite = LinearCurrentSprite(PackedBenchAnimation, startTimes[p], animationTime);
+            if (sprite < 0) {
+                startTimes[p] = animationTime - p * 5;
+            }
+            sum += sprite;
+        }
+        Sink = sum;
+    });
+    Bench("TAnimation::Draw x 10", 10 * BenchAnimation.GetSize(), [&]() {
+        for (unsigned int p = 0; p < 10; ++p) {
+            BenchAnimation.Draw(canvas, (step + p) % BenchAnimation.GetCount(), p * 30);
+        }
+        ++step;
+    });
+    Bench("TPackedAnimation::Draw x 10", 10 * BenchAnimation.GetSize(), [&]() {
+        for (unsigned int p = 0; p < 10; ++p) {
+            PackedBenchAnimation.Draw(canvas, (step + p) % BenchAnimation.GetCount(), p * 30);
+        }
+        ++step;
+    });
+
+    TRandomSmoothBlenderActor<decltype(colors)> randomSmoothBlender(colors);
+    Bench("TRandomSmoothBlenderActor::Draw", NUM_LEDS, [&]() {
+        randomSmoothBlender.Draw(canvas);
+    });
+    TSingleRandomSmoothBlenderActor<decltype(colors)> singleRandomSmoothBlender(colors, canvas);
+    Bench("TSingleRandomSmoothBlenderActor::Draw", NUM_LEDS, [&]() {
+        singleRandomSmoothBlender.Draw(canvas);
+    });
+
+    uint32_t white[] = {0xFFFFFF};
+    BenchMove("TPatternActor::Move", TPatternActor<decltype(pattern)>(pattern, 1, true, 40));
+    BenchMove("TSmoothPatternActor::Move", TSmoothPatternActor<decltype(pattern)>(pattern, true));
+    BenchMove("TChaoticPatternMovementActor::Move", TChaoticPatternMovementActor<decltype(pattern)>(pattern));
+    BenchMove("TChaoticPatternMovementWithRandomTrailActor::Move", TChaoticPatternMovementWithRandomTrailActor<decltype(pattern)>(pattern));
+    BenchMove("TRandomFillActor::Move", TRandomFillActor<>());
+    BenchMove("TRandomShifterActor::Move", TRandomShifterActor<>());
+    BenchMove("TRandomSelectorShifterActor::Move", TRandomSelectorShifterActor<decltype(colors)>(colors));
+    BenchMove("TRandomSelectorSmoothShifterActor::Move", TRandomSelectorSmoothShifterActor<decltype(colors)>(colors));
+    BenchMove("TRandomSmoothBlenderActor::Move", TRandomSmoothBlenderActor<decltype(colors)>(colors));
+    BenchMove("TRandomFastBlenderActor::Move", TRandomFastBlenderActor<decltype(colors)>(colors, canvas));
+    BenchMove("TSingleRandomSmoothBlenderActor::Move", TSingleRandomSmoothBlenderActor<decltype(colors)>(colors, canvas));
+    BenchMove("TSingleColorGradientActor::Move", TSingleColorGradientActor<>(0xFFA500));
+    BenchMove("TDecayingSplashesActor::Move", TDecayingSplashesActor<decltype(colors)>(1, 5, colors));
+    BenchMove("TDecayingSplashesActor::Move white", TDecayingSplashesActor<decltype(white)>(1, 5, white));
+    BenchMove("TDecayingSplashesActor::Move exponential", TDecayingSplashesActor<decltype(colors)>(1, 5, colors, EDecayMode::Exponential));
+    BenchMove("TDecayingSplashesActor::Move 2 per step", TDecayingSplashesActor<decltype(colors)>(2, 5, colors));
+    BenchMove("TSingleColorActor::Move", TSingleColorActor<>(0xFFA500));
+    BenchMove("TShiftRandomColorsActor::Move", TShiftRandomColorsActor<decltype(colors)>(colors));
+    BenchMove("TProportionalColorsActor::Move", TProportionalColorsActor<decltype(colors)>(colors));
+    BenchMove("TProportionalColorsActor::Move scrolling", TProportionalColorsActor<decltype(colors)>(colors, 22));
+    BenchMove("TAnimationActor::Move", TAnimationActor<decltype(BenchAnimation), 10>(BenchAnimation));
+    BenchMove("TAnimationActor::Move packed", TAnimationActor<decltype(PackedBenchAnimation), 10>(PackedBenchAnimation));
+
+    // the same actor for a power of two canvas wraps around with a mask instead of a division
+    const uint32_t patternColors[] = {0x000000, 0x101010, 0x404040, 0xFFFFFF, 0x404040, 0x101010, 0x000000};
+    TPatternActor<decltype(patternColors), NUM_LEDS> pattern300(patternColors, 1, true);
+    Bench("TPatternActor<NUM_LEDS>::Draw", NUM_LEDS, [&]() {
+        pattern300.Draw(canvas);
+    });
+    TCanvasOf<256> canvas256;
+    TPatternActor<decltype(patternColors), 256> pattern256(patternColors, 1, true);
+    Bench("TPatternActor<256>::Draw", 256, [&]() {
+        pattern256.Draw(canvas256);
+    });
+
+    TActorArena& arena = TActorArena::Get();
+    // the actors keeping palette indices have to stay out of the canvas sized slots
+    static_assert(sizeof(TRandomSelectorShifterActor<decltype(colors)>) <= TActorArena::SMALL_SLOT_SIZE, "indexed actor outgrew the small slots");
+    static_assert(sizeof(TRandomSelectorSmoothShifterActor<decltype(colors)>) <= TActorArena::SMALL_SLOT_SIZE, "indexed actor outgrew the small slots");
+    static_assert(sizeof(TRandomSmoothBlenderActor<decltype(colors)>) <= TActorArena::SMALL_SLOT_SIZE, "indexed actor outgrew the small slots");
+    printf("Actor arena %u bytes: %u x %u small, %u x %u canvas, %u x %u large\n", unsigned(sizeof(TActorArena)),
+        TActorArena::SMALL_SLOTS, TActorArena::SMALL_SLOT_SIZE, TActorArena::CANVAS_SLOTS, TActorArena::CANVAS_SLOT_SIZE,
+        TActorArena::LARGE_SLOTS, TActorArena::LARGE_SLOT_SIZE);
+    // an actor built for a shorter canvas, specialised for its power of two length
+    TDecayingSplashesActor<decltype(colors), 64> splashes64(1, 5, colors);
+    TCanvasOf<64> canvas64;
+    Bench("TDecayingSplashesActor<64>::Move", 64, [&]() {
+        Clock.Advance(10000);
+        splashes64.Move(canvas64, millis());
+    });
+
+    // from the arena like in the firmware, Create() doesn't compile for an actor larger than a slot
+    TCompositorActor<3>& compositor = *arena.Create<TCompositorActor<3>>();
+    compositor.AddLayer(arena.Create<TProportionalColorsActor<decltype(colors)>>(colors));
+    compositor.AddLayer(arena.Create<TRandomSelectorShifterActor<decltype(colors)>>(colors), EBlendMode::Alpha, TColorSmoother::MERGE_MAX / 2);
+    compositor.AddLayer(arena.Create<TDecayingSplashesActor<decltype(colors)>>(3, 5, colors), EBlendMode::Add);
+    compositor.Move(canvas, millis());
+    Bench("TCompositorActor<3>::Draw", NUM_LEDS, [&]() {
+        compositor.Draw(canvas);
+    });
+    Bench("TCompositorActor<3>::Move", NUM_LEDS, [&]() {
+        Clock.Advance(10000);
+        compositor.Move(canvas, millis());
+    });
+
+    // white splashes multiplied over the scrolling rainbow show through as rainbow coloured splashes
+    const uint32_t rainbow[] = {0xFF0000, 0xFF7F00, 0xFFFF00, 0x00FF00, 0x0000FF, 0x2E2B5F, 0x8B00FF};
+    TCompositorActor<2>& splashes = *arena.Create<TCompositorActor<2>>();
+    splashes.AddLayer(arena.Create<TProportionalColorsActor<decltype(rainbow)>>(rainbow, 22));
+    splashes.AddLayer(arena.Create<TDecayingSplashesActor<decltype(white)>>(1, 5, white), EBlendMode::Multiply);
+    Bench("TCompositorActor<2>::Move rainbow splashes", NUM_LEDS, [&]() {
+        Clock.Advance(10000);
+        splashes.Move(canvas, millis());
+    });
+
+    // the last entry of the table, the worst case of the lookup
+    TSimulatedSerial port(nullptr);
+    TCommandLine line(port);
+    Bench("TCommandLine read, split, find (PING)", 1, [&]() {
+        port.Feed("PING\n");
+        if (line.Read()) {
+            line.Split();
+            Sink = FindCommand(BenchCommands, line) != nullptr;
+        }
+    });
+
+    // a whole frame through the receiver, the host side costs the firmware nothing more than this
+    static uint8_t frame[2 + 1 + 2 + TFrameReceiver::FRAME_SIZE + 2];
+    uint8_t* f = frame;
+    *f++ = TFrameReceiver::MAGIC_0;
+    *f++ = TFrameReceiver::MAGIC_1;
+    *f++ = TFrameReceiver::TYPE_FULL;
+    *f++ = TFrameReceiver::FRAME_SIZE & 0xFF;
+    *f++ = TFrameReceiver::FRAME_SIZE >> 8;
+    for (unsigned int i = 0; i < TFrameReceiver::FRAME_SIZE; ++i) {
+        *f++ = random(256);
+    }
+    uint32_t sum1 = 0;
+    uint32_t sum2 = 0;
+    for (uint8_t* b = frame + 2; b != f; ++b) {
+        sum1 = (sum1 + *b) % 255;
+        sum2 = (sum2 + sum1) % 255;
+    }
+    *f++ = sum1;
+    *f++ = sum2;
+    static TFrameReceiver receiver;
+    Bench("TFrameReceiver::Read", NUM_LEDS, [&]() {
+        TSimulatedSerial stream(nullptr);
+        stream.Feed(frame, sizeof(frame));
+        while (!receiver.Read(stream)) {
+        }
+    });
+    Sink = receiver.Errors;
+
+    printf("full frame %u bytes\n", unsigned(sizeof(frame)));
+    uint32_t streamPattern[] = {0x000000, 0x101010, 0x404040, 0xFFFFFF, 0xFFFFFF, 0x404040, 0x101010, 0x000000};
+    BenchEncoder("stream TDecayingSplashesActor", TDecayingSplashesActor<decltype(colors)>(1, 5, colors), 1000);
+    BenchEncoder("stream TShiftRandomColorsActor", TShiftRandomColorsActor<decltype(colors)>(colors), 1000);
+    BenchEncoder("stream TRandomSelectorShifterActor", TRandomSelectorShifterActor<decltype(colors)>(colors), 1000);
+    BenchEncoder("stream TRandomSelectorSmoothShifterActor", TRandomSelectorSmoothShifterActor<decltype(colors)>(colors), 1000);
+    BenchEncoder("stream TPatternActor", TPatternActor<decltype(streamPattern)>(streamPattern, 1, true, 40), 1000);
+    BenchEncoder("stream TRandomFastBlenderActor", TRandomFastBlenderActor<decltype(colors)>(colors, canvas), 1000);
+    BenchEncoder("stream TSingleRandomSmoothBlenderActor", TSingleRandomSmoothBlenderActor<decltype(colors)>(colors, canvas), 1000);
+    BenchEncoder("stream TRandomSmoothBlenderActor", TRandomSmoothBlenderActor<decltype(colors)>(colors), 1000);
+    if (FailedChecks != 0) {
+        printf("%u checks FAILED\n", FailedChecks);
+        return 1;
+    }
+    return 0;
+}
+
+#endif
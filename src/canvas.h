@@ -0,0 +1,68 @@
+#pragma once
+
+#include "platform.h"
+
+// Full precision 0xRRGGBB frame the actors draw into, the output stage turns it into strip bytes.
+// The length is a template argument, so loops over it have constant bounds and wrapping around
+// a power of two length is a mask.
+template <unsigned int Length>
+class TCanvasOf {
+public:
+    static_assert(Length != 0, "empty canvas");
+
+    static constexpr unsigned int GetCount() {
+        return Length;
+    }
+
+    // index as a position on the canvas, counting on from the start past the end
+    static constexpr unsigned int Wrap(unsigned int index) {
+        return (Length & (Length - 1)) == 0 ? index & (Length - 1) : index % Length;
+    }
+
+    uint32_t* GetPixels() {
+        return Pixels;
+    }
+
+    const uint32_t* GetPixels() const {
+        return Pixels;
+    }
+
+    uint32_t Get(unsigned int index) const {
+        return index < Length ? Pixels[index] : 0;
+    }
+
+    void Set(unsigned int index, uint32_t color) {
+        if (index < Length) {
+            Pixels[index] = color;
+        }
+    }
+
+    void Write(unsigned int first, const uint32_t* colors, unsigned int count) {
+        if (first < Length) {
+            count = min(count, Length - first);
+            memcpy(Pixels + first, colors, count * sizeof(uint32_t));
+        }
+    }
+
+    void Fill(unsigned int first, uint32_t color, unsigned int count) {
+        if (first < Length) {
+            count = min(count, Length - first);
+            for (uint32_t* p = Pixels + first; count != 0; --count) {
+                *p++ = color;
+            }
+        }
+    }
+
+    void Read(unsigned int first, uint32_t* colors, unsigned int count) const {
+        if (first < Length) {
+            count = min(count, Length - first);
+            memcpy(colors, Pixels + first, count * sizeof(uint32_t));
+        }
+    }
+
+protected:
+    uint32_t Pixels[Length] = {};
+};
+
+// the canvas of all strips
+using TCanvas = TCanvasOf<NUM_LEDS>;
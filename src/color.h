@@ -0,0 +1,86 @@
+#pragma once
+
+#include "platform.h"
+#include "pixels.h"
+#include "swar.h"
+
+union TColorRGB {
+    uint32_t Value;
+    struct {
+        uint32_t B:8;
+        uint32_t G:8;
+        uint32_t R:8;
+    };
+};
+
+enum class EBlendMode {
+    Replace,
+    Add,
+    Max,
+    Alpha,
+    Multiply,
+};
+
+class TColorSmoother {
+public:
+    // amounts are fixed point, MERGE_MAX means "all of b"
+    static constexpr uint32_t MERGE_MAX = 256;
+
+    static constexpr uint32_t GetMergeAmount(uint32_t part, uint32_t total) {
+        return (part * MERGE_MAX + total / 2) / total;
+    }
+
+    static uint32_t MergeColors(uint32_t a, uint32_t b, uint32_t amount_b) {
+        return TSwar::Lerp(a, b, amount_b);
+    }
+
+    // puts the layer buffer over the base one, looking at the mode once rather than per pixel;
+    // amount is used by EBlendMode::Alpha
+    static void BlendColors(uint32_t* base, const uint32_t* layer, EBlendMode mode, uint32_t amount, unsigned int count) {
+        switch (mode) {
+            case EBlendMode::Replace:
+                memcpy(base, layer, count * sizeof(uint32_t));
+                break;
+            case EBlendMode::Add:
+                TSwar::Add(base, layer, count);
+                break;
+            case EBlendMode::Max:
+                TSwar::Max(base, layer, count);
+                break;
+            case EBlendMode::Alpha:
+                TSwar::Lerp(base, layer, amount, count);
+                break;
+            case EBlendMode::Multiply:
+                TSwar::Multiply(base, layer, count);
+                break;
+        }
+    }
+
+    template <unsigned int Length, unsigned int Size>
+    static void SmoothApply(TCanvasOf<Length>& canvas, const TPixelRing<Size>& pixelsDesired, uint32_t amount) {
+        static_assert(Size <= Length, "pixels don't fit the canvas");
+        uint32_t* pixels = canvas.GetPixels();
+        uint32_t previous = pixelsDesired[Size - 1];
+        pixelsDesired.ForEach([&](unsigned int index, uint32_t color) {
+            pixels[index] = MergeColors(color, previous, amount);
+            previous = color;
+        });
+    }
+
+    template <unsigned int Length, unsigned int Size, typename PaletteType>
+    static void SmoothApply(TCanvasOf<Length>& canvas, const TPixelRing<Size, uint8_t>& pixelsDesired, const PaletteType& palette, uint32_t amount) {
+        static_assert(Size <= Length, "pixels don't fit the canvas");
+        uint32_t* pixels = canvas.GetPixels();
+        uint32_t previous = palette[pixelsDesired[Size - 1]];
+        pixelsDesired.ForEach([&](unsigned int index, uint8_t pixel) {
+            uint32_t color = palette[pixel];
+            pixels[index] = MergeColors(color, previous, amount);
+            previous = color;
+        });
+    }
+
+    template <typename PatternType>
+    static void MaskPattern(const PatternType& patternSource, PatternType& patternTarget, uint32_t patternMask) {
+        TSwar::Multiply(patternTarget, patternSource, patternMask, countof(patternSource));
+    }
+};
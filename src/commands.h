@@ -0,0 +1,110 @@
+#pragma once
+
+#include "platform.h"
+
+#define COMMAND_LINE_SIZE 32
+#define COMMAND_MAX_TOKENS 3
+
+// Line based commands from one serial port, read into a fixed buffer and split in place,
+// so nothing is allocated. A line ends with \n or \r, a line longer than the buffer is
+// dropped whole rather than run cut off. Bytes outside ASCII are left in the port for
+// the binary frame stream.
+class TCommandLine {
+public:
+    TCommandLine(TSerialType& port)
+        : Port(port)
+    {}
+
+    // reads at most a buffer worth of bytes, true when a complete line is in GetLine()
+    bool Read() {
+        if (Complete) {
+            Length = 0;
+            Complete = false;
+        }
+        for (unsigned int n = 0; n < COMMAND_LINE_SIZE && Port.available() && Port.peek() < 0x80; ++n) {
+            char c = Port.read();
+            if (c == '\n' || c == '\r') {
+                if (Length != 0 && !Overflow) {
+                    Line[Length] = 0;
+                    Complete = true;
+                    return true;
+                }
+                Length = 0;
+                Overflow = false;
+            } else if (Length < COMMAND_LINE_SIZE - 1) {
+                Line[Length++] = c;
+            } else {
+                Overflow = true;
+            }
+        }
+        return false;
+    }
+
+    const char* GetLine() const {
+        return Line;
+    }
+
+    // splits the line at spaces, anything past the last token stays in it
+    void Split() {
+        Count = 0;
+        char* p = Line;
+        while (Count < COMMAND_MAX_TOKENS) {
+            while (*p == ' ' || *p == '\t') {
+                ++p;
+            }
+            if (*p == 0) {
+                break;
+            }
+            Tokens[Count++] = p;
+            if (Count == COMMAND_MAX_TOKENS) {
+                break;
+            }
+            while (*p != 0 && *p != ' ' && *p != '\t') {
+                ++p;
+            }
+            if (*p != 0) {
+                *p++ = 0;
+            }
+        }
+    }
+
+    unsigned int GetCount() const {
+        return Count;
+    }
+
+    // empty for tokens past the end
+    const char* operator [](unsigned int index) const {
+        return index < Count ? Tokens[index] : "";
+    }
+
+    TSerialType& GetPort() {
+        return Port;
+    }
+
+protected:
+    TSerialType& Port;
+    char Line[COMMAND_LINE_SIZE];
+    unsigned int Length = 0;
+    bool Overflow = false;
+    bool Complete = false;
+    const char* Tokens[COMMAND_MAX_TOKENS];
+    unsigned int Count = 0;
+};
+
+struct TCommand {
+    const char* Name;
+    unsigned int Args; // tokens after the name
+    void (*Handler)(TCommandLine& line);
+    bool Quiet; // not echoed and doesn't count as user activity, for keepalives
+};
+
+// the entry for the first token with a matching number of arguments, nullptr if there is none
+template <unsigned int Count>
+const TCommand* FindCommand(const TCommand (&commands)[Count], const TCommandLine& line) {
+    for (unsigned int i = 0; i < Count; ++i) {
+        if (line.GetCount() == commands[i].Args + 1 && strcmp(line[0], commands[i].Name) == 0) {
+            return &commands[i];
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "platform.h"
+#include "actors.h"
+
+// Runs several actors into their own canvases and puts them over each other, bottom layer first,
+// one pass over the pixels per layer. Owns the actors of its layers.
+template <unsigned int MaxLayers>
+class TCompositorActor : public TActor, TColorSmoother {
+public:
+    struct TLayer {
+        TActor* Actor = nullptr;
+        EBlendMode Mode = EBlendMode::Replace;
+        uint32_t Amount = MERGE_MAX;
+        TCanvas Canvas;
+    };
+
+    virtual ~TCompositorActor() {
+        for (unsigned int l = 0; l < LayerCount; ++l) {
+            delete Layers[l].Actor;
+        }
+    }
+
+    // the mode of the bottom layer is ignored, amount is only used by EBlendMode::Alpha
+    bool AddLayer(TActor* actor, EBlendMode mode = EBlendMode::Replace, uint32_t amount = MERGE_MAX) {
+        if (actor == nullptr) {
+            return false;
+        }
+        if (LayerCount == MaxLayers) {
+            delete actor;
+            return false;
+        }
+        TLayer& layer = Layers[LayerCount++];
+        layer.Actor = actor;
+        layer.Mode = mode;
+        layer.Amount = amount;
+        Invalidate();
+        return true;
+    }
+
+    virtual void Draw(TCanvas& canvas) override {
+        if (LayerCount == 0) {
+            return;
+        }
+        // layer by layer over the whole canvas, so each blend mode runs as one tight loop
+        canvas.Write(0, Layers[0].Canvas.GetPixels(), canvas.GetCount());
+        for (unsigned int l = 1; l < LayerCount; ++l) {
+            const TLayer& layer = Layers[l];
+            BlendColors(canvas.GetPixels(), layer.Canvas.GetPixels(), layer.Mode, layer.Amount, canvas.GetCount());
+        }
+    }
+
+    virtual bool Move(TCanvas& canvas, uint32_t now) override {
+        for (unsigned int l = 0; l < LayerCount; ++l) {
+            if (Layers[l].Actor->Move(Layers[l].Canvas, now)) {
+                Invalidate();
+            }
+        }
+        return DrawIfChanged(canvas);
+    }
+
+    virtual uint32_t GetIdleTime(uint32_t now) const override {
+        uint32_t idleTime = IDLE_FOREVER;
+        for (unsigned int l = 0; l < LayerCount; ++l) {
+            idleTime = min(idleTime, Layers[l].Actor->GetIdleTime(now));
+        }
+        return Changed ? 0 : idleTime;
+    }
+
+protected:
+    TLayer Layers[MaxLayers];
+    unsigned int LayerCount = 0;
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "platform.h"
+#include "actors.h"
+
+// Keeps the outgoing actor running next to the incoming one, each in its own canvas,
+// and blends from one to the other over FadeTime ms from the first frame it is moved in.
+// Owns both actors.
+class TCrossfadeActor : public TActor, TColorSmoother {
+public:
+    TCrossfadeActor(TActor* from, const TCanvas& fromCanvas, TActor* to, const TCanvas& toCanvas, uint32_t fadeTime)
+        : From(from)
+        , To(to)
+        , FromCanvas(fromCanvas)
+        , ToCanvas(toCanvas)
+        , FadeTime(max(fadeTime, 1u))
+    {}
+
+    virtual ~TCrossfadeActor() {
+        delete From;
+        delete To;
+    }
+
+    // switching again mid fade: the actor faded in so far becomes the one fading out, the
+    // canvases are reused so a second crossfade never has to be allocated
+    void Restart(TActor* to, const TCanvas& toCanvas, uint32_t fadeTime) {
+        delete From;
+        From = To;
+        FromCanvas = ToCanvas;
+        To = to;
+        ToCanvas = toCanvas;
+        FadeTime = max(fadeTime, 1u);
+        Started = false;
+        Done = false;
+        Invalidate();
+    }
+
+    // true once the last frame, which is all the incoming actor, has been drawn
+    bool IsDone() const {
+        return Done;
+    }
+
+    // hands the incoming actor over with the canvas it has been drawing into
+    TActor* ReleaseTo() {
+        TActor* to = To;
+        To = nullptr;
+        return to;
+    }
+
+    virtual void Draw(TCanvas& canvas) override {
+        uint32_t amount = GetMergeAmount(min(uint32_t(FrameTime - StartTime), FadeTime), FadeTime);
+        TSwar::Lerp(canvas.GetPixels(), FromCanvas.GetPixels(), ToCanvas.GetPixels(), amount, canvas.GetCount());
+        Done = amount == MERGE_MAX;
+    }
+
+    virtual bool Move(TCanvas& canvas, uint32_t now) override {
+        if (!Started) {
+            Started = true;
+            StartTime = now;
+        }
+        FrameTime = now;
+        From->Move(FromCanvas, now);
+        To->Move(ToCanvas, now);
+        Invalidate();
+        return DrawIfChanged(canvas);
+    }
+
+    virtual uint32_t GetIdleTime(uint32_t) const override {
+        return 0;
+    }
+
+protected:
+    TActor* From;
+    TActor* To;
+    TCanvas FromCanvas;
+    TCanvas ToCanvas;
+    uint32_t FadeTime;
+    uint32_t StartTime = 0;
+    uint32_t FrameTime = 0; // of the frame being drawn, for Draw()
+    bool Done = false;
+};
@@ -0,0 +1,142 @@
+#pragma once
+
+// Host side counterpart of TFrameReceiver: encodes each frame as the smaller of a full frame
+// and an update against the frame before it. Not used by the firmware.
+
+#include <vector>
+#include "stream.h"
+
+class TFrameEncoder {
+public:
+    static constexpr unsigned int MAX_SCROLL = 4; // pixels either way tried as OP_SCROLL
+    static constexpr unsigned int MIN_FILL = 4; // equal pixels worth an OP_FILL inside a span
+
+    // appends the stream frame for NUM_LEDS RGB pixels to out
+    void Encode(const uint8_t* rgb, std::vector<uint8_t>& out) {
+        if (HasPrevious) {
+            Payload.clear();
+            EncodeUpdate(rgb);
+        }
+        if (HasPrevious && Payload.size() < TFrameReceiver::FRAME_SIZE) {
+            Append(TFrameReceiver::TYPE_UPDATE, Payload.data(), Payload.size(), out);
+        } else {
+            Append(TFrameReceiver::TYPE_FULL, rgb, TFrameReceiver::FRAME_SIZE, out);
+        }
+        memcpy(Previous, rgb, sizeof(Previous));
+        HasPrevious = true;
+    }
+
+protected:
+    uint8_t Previous[TFrameReceiver::FRAME_SIZE];
+    uint8_t Scrolled[TFrameReceiver::FRAME_SIZE];
+    bool HasPrevious = false;
+    std::vector<uint8_t> Payload;
+
+    static bool Equal(const uint8_t* a, const uint8_t* b, unsigned int i) {
+        return memcmp(a + i * 3, b + i * 3, 3) == 0;
+    }
+
+    static void Append(uint8_t type, const uint8_t* payload, unsigned int size, std::vector<uint8_t>& out) {
+        TFletcher16 sum;
+        uint8_t header[] = {TFrameReceiver::MAGIC_0, TFrameReceiver::MAGIC_1, type, uint8_t(size), uint8_t(size >> 8)};
+        out.insert(out.end(), header, header + sizeof(header));
+        out.insert(out.end(), payload, payload + size);
+        for (unsigned int i = 2; i < sizeof(header); ++i) {
+            sum.Add(header[i]);
+        }
+        for (unsigned int i = 0; i < size; ++i) {
+            sum.Add(payload[i]);
+        }
+        out.push_back(sum.Get() & 0xFF);
+        out.push_back(sum.Get() >> 8);
+    }
+
+    void Put16(unsigned int value) {
+        Payload.push_back(value & 0xFF);
+        Payload.push_back(value >> 8);
+    }
+
+    // previous frame with every pixel moved up by pixels
+    void Scroll(unsigned int by) {
+        for (unsigned int i = 0; i < NUM_LEDS; ++i) {
+            memcpy(Scrolled + (i + by) % NUM_LEDS * 3, Previous + i * 3, 3);
+        }
+    }
+
+    unsigned int CountChanged(const uint8_t* from, const uint8_t* rgb) const {
+        unsigned int changed = 0;
+        for (unsigned int i = 0; i < NUM_LEDS; ++i) {
+            changed += !Equal(from, rgb, i);
+        }
+        return changed;
+    }
+
+    void EncodeUpdate(const uint8_t* rgb) {
+        // the scroll that leaves the fewest pixels to send, an OP_SCROLL costs about one pixel
+        unsigned int bestScroll = 0;
+        unsigned int bestChanged = CountChanged(Previous, rgb);
+        for (unsigned int s = 1; s <= MAX_SCROLL * 2; ++s) {
+            unsigned int by = s <= MAX_SCROLL ? s : NUM_LEDS - (s - MAX_SCROLL);
+            Scroll(by);
+            unsigned int changed = CountChanged(Scrolled, rgb) + 1;
+            if (changed < bestChanged) {
+                bestChanged = changed;
+                bestScroll = by;
+            }
+        }
+        const uint8_t* from = Previous;
+        if (bestScroll != 0) {
+            Scroll(bestScroll);
+            from = Scrolled;
+            Payload.push_back(uint8_t(TFrameReceiver::OP_SCROLL));
+            Put16(bestScroll);
+        }
+        unsigned int i = 0;
+        while (i < NUM_LEDS) {
+            if (Equal(from, rgb, i)) {
+                ++i;
+                continue;
+            }
+            // a run of changed pixels, single unchanged ones are cheaper to resend than a new op
+            unsigned int end = i + 1;
+            while (end < NUM_LEDS && (!Equal(from, rgb, end) || (end + 1 < NUM_LEDS && !Equal(from, rgb, end + 1)))) {
+                ++end;
+            }
+            EncodeRun(rgb, i, end);
+            i = end;
+        }
+    }
+
+    // pixels first..last-1 as spans, with long single colour stretches as fills
+    void EncodeRun(const uint8_t* rgb, unsigned int first, unsigned int last) {
+        unsigned int spanStart = first;
+        unsigned int i = first;
+        while (i < last) {
+            unsigned int same = i + 1;
+            while (same < last && memcmp(rgb + same * 3, rgb + i * 3, 3) == 0) {
+                ++same;
+            }
+            if (same - i >= MIN_FILL) {
+                EncodeSpan(rgb, spanStart, i);
+                Payload.push_back(uint8_t(TFrameReceiver::OP_FILL));
+                Put16(i);
+                Put16(same - i);
+                Payload.insert(Payload.end(), rgb + i * 3, rgb + i * 3 + 3);
+                spanStart = same;
+            }
+            i = same;
+        }
+        EncodeSpan(rgb, spanStart, last);
+    }
+
+    void EncodeSpan(const uint8_t* rgb, unsigned int first, unsigned int last) {
+        while (first < last) {
+            unsigned int count = min(last - first, 255u);
+            Payload.push_back(uint8_t(TFrameReceiver::OP_SPAN));
+            Put16(first);
+            Payload.push_back(count);
+            Payload.insert(Payload.end(), rgb + first * 3, rgb + (first + count) * 3);
+            first += count;
+        }
+    }
+};
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "platform.h"
+
+#define GRADIENT_MAX_STOPS 16u
+
+// a colour at Position along the gradient, 0..TGradient::END over all its pixels
+struct TGradientStop {
+    uint32_t Position;
+    uint32_t Color;
+};
+
+// Linear gradient between stops at any positions. Every channel steps along a run of pixels in
+// 16.16 fixed point, so there is one division per channel and stop pair rather than per pixel.
+// Before the first stop the pixels take its colour, after the last stop the last colour.
+// The phase scrolls the gradient around the pixels, in END per full turn.
+class TGradient {
+public:
+    static constexpr uint32_t END = 0x10000;
+
+    // stops ordered by Position, the ones beyond GRADIENT_MAX_STOPS are dropped
+    void SetStops(const TGradientStop* stops, unsigned int count) {
+        StopCount = min(count, GRADIENT_MAX_STOPS);
+        for (unsigned int i = 0; i < StopCount; ++i) {
+            Stops[i] = stops[i];
+        }
+    }
+
+    // the colours spaced evenly from 0 to END
+    template <typename ColorsType>
+    void SetColors(const ColorsType& colors) {
+        StopCount = min(countof(colors), GRADIENT_MAX_STOPS);
+        unsigned int steps = max(StopCount - 1, 1u);
+        for (unsigned int i = 0; i < StopCount; ++i) {
+            Stops[i].Position = (i * END + steps / 2) / steps;
+            Stops[i].Color = colors[i];
+        }
+    }
+
+    void SetColor(unsigned int index, uint32_t color) {
+        if (index < StopCount) {
+            Stops[index].Color = color;
+        }
+    }
+
+    unsigned int GetStopCount() const {
+        return StopCount;
+    }
+
+    // the whole gradient over count pixels, pixel i shows the colour at i + phase * count / END
+    void Render(uint32_t* pixels, unsigned int count, uint32_t phase = 0) const {
+        if (StopCount == 0) {
+            memset(pixels, 0, count * sizeof(uint32_t));
+            return;
+        }
+        // positions here are 16.16 fixed point pixels
+        uint32_t total = count << 16;
+        uint32_t x = (phase % END) * count;
+        unsigned int i = 0;
+        while (i < count) {
+            unsigned int next = 0;
+            while (next < StopCount && Stops[next].Position * count <= x) {
+                ++next;
+            }
+            uint32_t end = next < StopCount ? Stops[next].Position * count : total;
+            unsigned int run = min((end - x + 0xFFFF) >> 16, count - i);
+            if (next == 0 || next == StopCount) {
+                uint32_t color = Stops[next == 0 ? 0 : StopCount - 1].Color & 0xFFFFFF;
+                for (uint32_t* p = pixels + i; p != pixels + i + run; ++p) {
+                    *p = color;
+                }
+            } else {
+                Interpolate(pixels + i, run, Stops[next - 1], Stops[next], x - Stops[next - 1].Position * count, end - Stops[next - 1].Position * count);
+            }
+            i += run;
+            x += run << 16;
+            if (x >= total) {
+                x -= total;
+            }
+        }
+    }
+
+protected:
+    TGradientStop Stops[GRADIENT_MAX_STOPS];
+    unsigned int StopCount = 0;
+
+    // run pixels from offset into a span between two stops, channels are kept as 8.16 with the rounding added in
+    static void Interpolate(uint32_t* pixels, unsigned int run, const TGradientStop& from, const TGradientStop& to, uint32_t offset, uint32_t span) {
+        int32_t value[3];
+        int32_t step[3];
+        for (int c = 0; c < 3; ++c) {
+            int shift = 16 - c * 8;
+            int32_t a = (from.Color >> shift) & 0xFF;
+            int32_t b = (to.Color >> shift) & 0xFF;
+            int64_t slope = (int64_t(b - a) << 32) / span;
+            value[c] = (a << 16) + int32_t(slope * offset >> 16) + 0x8000;
+            // the slope only gets big when the stops are less than a pixel apart, and then the run is 1
+            step[c] = run > 1 ? int32_t(slope) : 0;
+        }
+        int32_t r = value[0];
+        int32_t g = value[1];
+        int32_t b = value[2];
+        for (uint32_t* p = pixels; p != pixels + run; ++p) {
+            *p = (uint32_t(r) & 0xFF0000) | ((uint32_t(g) >> 8) & 0x00FF00) | (uint32_t(b) >> 16);
+            r += step[0];
+            g += step[1];
+            b += step[2];
+        }
+    }
+};
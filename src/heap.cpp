@@ -0,0 +1,55 @@
+#include "heap.h"
+
+static volatile uint32_t HeapAllocations = 0;
+
+uint32_t GetHeapAllocations() {
+    return HeapAllocations;
+}
+
+#ifdef ARDUINO
+
+extern "C" {
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size) {
+    ++HeapAllocations;
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    ++HeapAllocations;
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    ++HeapAllocations;
+    return __real_realloc(ptr, size);
+}
+
+}
+
+#else
+
+#include <new>
+
+void* operator new(size_t size) {
+    ++HeapAllocations;
+    void* ptr = malloc(size != 0 ? size : 1);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+#endif
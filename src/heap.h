@@ -0,0 +1,7 @@
+#pragma once
+
+#include "platform.h"
+
+// Number of heap allocations since reset: malloc, calloc and realloc on the board (wrapped through
+// the linker, see platformio.ini), operator new on the host.
+uint32_t GetHeapAllocations();
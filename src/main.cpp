@@ -1,1013 +1,480 @@
-#define PIN 5
-#define NUM_LEDS 300
-#include <Adafruit_NeoPixel_ZeroDMA.h>
-//#include <Adafruit_NeoPixel.h>
-#include "sprite.h"
-
-using TStripType = Adafruit_NeoPixel_ZeroDMA;
-//using TStripType = Adafruit_NeoPixel;
-TStripType Strip(NUM_LEDS, PIN, NEO_GRB + NEO_KHZ800);
-
-template <typename T, const unsigned int N>
-constexpr unsigned int countof(T (&)[N]) { return N; }
+#include <errno.h>
+#include "platform.h"
+#include "actors.h"
+#include "asset.h"
+#include "crossfade.h"
+#include "commands.h"
+#include "heap.h"
+#include "output.h"
+#include "scheduler.h"
+#include "stream.h"
+
+const uint8_t StripPins[] = {STRIP_PINS};
+static_assert(countof(StripPins) == STRIP_COUNT, "STRIP_PINS needs one pin per strip");
+TStripSet Strips(StripPins, STRIP_TYPE);
+TCanvas Canvas;
+TOutputStage Output(Strips);
+TFrameScheduler Scheduler(FRAME_RATE);
+TActorArena& Arena = TActorArena::Get();
+TProfiler& Profiler = TProfiler::Get();
+uint32_t BootHeapAllocations = 0;
 
 void setup() {
-    SerialUSB.begin(9600);
-    Serial1.begin(9600);
-    Strip.begin();
-    Strip.setBrightness(50);
+    SerialUSB.begin(SERIAL_BAUD);
+    Serial1.begin(SERIAL_BAUD);
+    Strips.Begin();
+    Output.SetBrightness(50);
+    TRandom::Get().Seed(GetEntropy());
+    BootHeapAllocations = GetHeapAllocations();
 }
 
-class TActor {
-public:
-    unsigned long Period = 1000; // ms
-    unsigned long LastDrawTime = 0;
-
-    virtual ~TActor() = default;
-    virtual void Draw(TStripType&) = 0;
-    virtual void Move(TStripType&) = 0;
-
-    bool IsTime() const {
-        return millis() - LastDrawTime >= Period;
-    }
-
-    void UpdateTime() {
-        LastDrawTime = millis();
-    }
-
-    void PostponeTime(uint32_t ahead) {
-        LastDrawTime = millis() + ahead;
-    }
-};
-
-union TColorRGB {
-    uint32_t Value;
-    struct {
-        uint32_t B:8;
-        uint32_t G:8;
-        uint32_t R:8;
-    };
-};
-
-class TColorSmoother {
-public:
-    static uint32_t MergeColors(uint32_t a, uint32_t b, float amount_b) {
-        float amount_a = 1 - min(amount_b, 1);
-        TColorRGB _a;
-        TColorRGB _b;
-        TColorRGB _r;
-
-        _a.Value = a;
-        _b.Value = b;
-        _r.Value = 0;
-        _r.R = min(round(_a.R * amount_a) + round(_b.R * amount_b), 255);
-        _r.G = min(round(_a.G * amount_a) + round(_b.G * amount_b), 255);
-        _r.B = min(round(_a.B * amount_a) + round(_b.B * amount_b), 255);
-        return _r.Value;
-    }
-
-    static void SmoothApply(TStripType& strip, uint32_t pixelsDesired[NUM_LEDS], float trans) {
-        auto pixels = strip.numPixels();
-        strip.setPixelColor(0, MergeColors(pixelsDesired[0], pixelsDesired[pixels - 1], trans));
-        for (unsigned int i = 1; i < pixels; ++i) {
-            strip.setPixelColor(i, MergeColors(pixelsDesired[i], pixelsDesired[i - 1], trans));
-        }
-    }
-
-    template <typename PatternType>
-    static void MaskPattern(const PatternType& patternSource, PatternType& patternTarget, uint32_t patternMask) {
-        TColorRGB mask;
-        mask.Value = patternMask;
-        for (unsigned int i = 0; i < countof(patternSource); ++i) {
-            TColorRGB target;
-            TColorRGB source;
-            source.Value = patternSource[i];
-            target.R = source.R * mask.R / 255;
-            target.G = source.G * mask.G / 255;
-            target.B = source.B * mask.B / 255;
-            patternTarget[i] = target.Value;
+unsigned long from_hex(const char* str) {
+    unsigned long v = 0;
+    for (unsigned int i = 0; str[i] != 0; ++i) {
+        unsigned long l = 0;
+        char c = str[i];
+        if (c >= '0' && c <= '9') {
+            l = c - '0';
+        } else if (c >= 'A' && c <= 'F') {
+            l = c - 'A' + 0xA;
         }
+        v <<= 4;
+        v |= l;
     }
-};
-
-template <typename T, int S>
-T GetRandom(const T(&choices)[S]) {
-    return choices[random(S)];
-}
-
-template <typename T, int S>
-void MakeRandom(T& result, const T(&choices)[S]) {
-    T r;
-    do {
-        r = GetRandom<T, S>(choices);
-    } while (result == r);
-    result = r;
-}
-
-template <typename T>
-void MakeRandom(T& result, const T(&choices)[1]) {
-    result = choices[0];
+    return v;
 }
 
-template <typename PatternType>
-class TPatternActor : public TActor {
-public:
-    TPatternActor(const PatternType& pattern, int step = 1, bool repeat = false, int space = 0)
-        : Pattern(pattern)
-        , Step(step)
-        , Repeat(repeat)
-        , Space(space)
-    {
-        Period = 50;
-    }
-
-    virtual void Draw(TStripType& strip) override {
-        auto pixels = strip.numPixels();
-        if (Repeat) {
-            for (unsigned int i = 0; i < pixels; ++i) {
-                strip.setPixelColor((I + i) % pixels, Pattern[i % countof(Pattern)]);
-                if (Space && (i % countof(Pattern)) == countof(Pattern) - 1) {
-                    i += Space;
-                }
-            }
-        } else {
-            for (unsigned int i = 0; i < countof(Pattern); ++i) {
-                strip.setPixelColor((I + i) % pixels, Pattern[i]);
-            }
-        }
-    }
-
-    virtual void Move(TStripType& strip) override {
-        if (IsTime()) {
-            I = (I + Step) % NUM_LEDS;
-            UpdateTime();
-        }
-        Draw(strip);
-    }
-
-protected:
-    const PatternType& Pattern;
-    int Step;
-    bool Repeat;
-    int Space;
-    int I = 0;
-};
-
-template <typename PatternType>
-class TSmoothPatternActor : public TActor, TColorSmoother {
-public:
-    static constexpr int SMOOTH_LEVEL = 20;
-
-    TSmoothPatternActor(const PatternType& pattern, bool repeat = false)
-        : Pattern(pattern)
-        , Repeat(repeat)
-    {
-        Period = 1;
-    }
-
-    virtual void Draw(TStripType& strip) override {
-        float trans = float(S) / SMOOTH_LEVEL;
-        SmoothApply(strip, PixelsDesired, trans);
-    }
-
-    virtual void Move(TStripType& strip) override {
-        if (IsTime()) {
-            S = (S + 1) % SMOOTH_LEVEL;
-            if (S == 0) {
-                I = (I + 1) % NUM_LEDS;
-                auto pixels = strip.numPixels();
-                if (Repeat) {
-                    for (unsigned int i = 0; i < pixels; ++i) {
-                        PixelsDesired[(I + i) % pixels] = Pattern[i % countof(Pattern)];
-                    }
-                } else {
-                    for (unsigned int i = 0; i < countof(Pattern); ++i) {
-                        PixelsDesired[(I + i) % pixels] = Pattern[i];
-                    }
-                }
-            }
-            UpdateTime();
-        }
-        Draw(strip);
-    }
-
-protected:
-    const PatternType& Pattern;
-    uint32_t PixelsDesired[NUM_LEDS];
-    bool Repeat;
-    int I = 0;
-    int S = 0;
-};
-
-template <typename PatternType>
-class TChaoticPatternMovementActor : public TActor {
-public:
-    TChaoticPatternMovementActor(const PatternType& pattern)
-        : Pattern(pattern)
-    {
-        Period = 1;
-    }
-
-    virtual void Draw(TStripType& strip) override {
-        auto pixels = strip.numPixels();
-        for (unsigned int i = 0; i < countof(Pattern); ++i) {
-            strip.setPixelColor((I + i) % pixels, Pattern[i]);
-        }
-    }
-
-    virtual void Move(TStripType& strip) override {
-        if (IsTime()) {
-            Period = 1;
-            I = (I + Step) % NUM_LEDS;
-            if (I == D) {
-                D = random(NUM_LEDS);
-                if (D > I) {
-                    Step = 1;
-                } else if (D < I) {
-                    Step = -1;
-                } else {
-                    Step = 0;
-                }
-                Period = 100;
-            }
-            UpdateTime();
-        }
-        Draw(strip);
-    }
-
-protected:
-    const PatternType& Pattern;
-    int I = 0;
-    int Step = 0;
-    int D = 0;
-};
-
-template <typename PatternType>
-class TChaoticPatternMovementWithRandomTrailActor : public TActor {
-public:
-    TChaoticPatternMovementWithRandomTrailActor(const PatternType& pattern)
-        : Pattern(pattern)
-    {
-        Period = 1;
-    }
-
-    virtual void Draw(TStripType& strip) override {
-        auto pixels = strip.numPixels();
-        for (unsigned int i = 0; i < countof(Pattern); ++i) {
-            strip.setPixelColor((I + i) % pixels, Pattern[i]);
-        }
-        if (Step < 0) {
-            strip.setPixelColor((I + countof(Pattern) + 1) % pixels, Trail);
-        }
-        if (Step > 0) {
-            strip.setPixelColor((I + pixels - 1) % pixels, Trail);
-        }
-    }
-
-    virtual void Move(TStripType& strip) override {
-        if (IsTime()) {
-            Period = 1;
-            if (D > I) {
-                Step = 1;
-            } else if (D < I) {
-                Step = -1;
-            }
-            I = (I + Step) % NUM_LEDS;
-            if (I == D) {
-                D = random(NUM_LEDS);
-                uint32_t color = 0;
-                color |= random(0x10);
-                color <<= 8;
-                color |= random(0x10);
-                color <<= 8;
-                color |= random(0x10);
-                Trail = color;
-                Period = 10;
-            }
-            UpdateTime();
-        }
-        Draw(strip);
-    }
-
-protected:
-    const PatternType& Pattern;
-    int I = 0;
-    int Step = 0;
-    int D = 0;
-    uint32_t Trail = 0;
-};
-
-class TRandomFillActor : public TActor {
-    uint32_t Pixels[NUM_LEDS];
-
-public:
-    TRandomFillActor() {
-        Period = 5000;
-    }
-
-    virtual void Draw(TStripType& strip) override {
-        for (unsigned int i = 0; i < countof(Pixels); ++i) {
-            strip.setPixelColor(i, Pixels[i]);
-        }        
-    }
-
-    virtual void Move(TStripType& strip) override {
-        if (IsTime()) {
-            for (unsigned int i = 0; i < countof(Pixels); ++i) {
-                uint32_t color = 0;
-                color |= random(256);
-                color <<= 8;
-                color |= random(256);
-                color <<= 8;
-                color |= random(256);
-                Pixels[i] = color;
-            }
-            UpdateTime();
-        }
-        Draw(strip);
-    }
-};
-
-class TRandomShifterActor : public TActor {
-    uint32_t Pixels[NUM_LEDS];
-
-public:
-    TRandomShifterActor() {
-        Period = 5;
-    }
-
-    virtual void Draw(TStripType& strip) override {
-        for (unsigned int i = 0; i < countof(Pixels); ++i) {
-            strip.setPixelColor(i, Pixels[i]);
-        }        
-    }
-
-    virtual void Move(TStripType& strip) override {
-        if (IsTime()) {
-            for (unsigned int i = NUM_LEDS - 1; i > 0; --i) {
-                Pixels[i] = Pixels[i - 1];
-            }
-            uint32_t color = 0;
-            color |= random(256);
-            color <<= 8;
-            color |= random(256);
-            color <<= 8;
-            color |= random(256);
-            Pixels[0] = color;
-            UpdateTime();
-        }
-        Draw(strip);
-    }
-};
+//uint32_t Pattern[] = {0x400040, 0x800080, 0xC000C0, 0xFF00FF};
+//uint32_t Pattern[] = {0x000000, 0xFFFFFF};
+const uint32_t Pattern[] = {0x000000, 0x010101, 0x101010, 0x202020, 0x404040, 0x808080, 0xC0C0C0, 0xFFFFFF, 0xFFFFFF, 0xFFFFFF,
+                      0xFFFFFF, 0xFFFFFF, 0xFFFFFF, 0xC0C0C0, 0x808080, 0x404040, 0x202020, 0x101010, 0x010101, 0x000000};
+const uint32_t ChaoticPattern[] = {0x000000, 0x010101, 0x101010, 0x404040, 0x101010, 0x010101, 0x000000};
 
-template <typename ColorsType>
-class TRandomSelectorShifterActor : public TActor {
-    uint32_t Pixels[NUM_LEDS];
+//uint32_t Colors[] = {0xFF0000, 0x00FF00, 0x0000FF};
+const uint32_t Colors[] = {0xFF0000, 0x00FF00, 0x0000FF, 0xFFFF00, 0x00FFFF, 0xFF00FF, /*pink*/0xFFC0CB, /*orange*/0xFFA500};
+const uint32_t WhiteColor[] = {0xFFFFFF};
+const uint32_t RainbowColors[] = {0xFF0000, 0xFF7F00, 0xFFFF00, 0x00FF00, 0x0000FF, 0x2E2B5F, 0x8B00FF};
 
-public:
-    TRandomSelectorShifterActor(const ColorsType& colors)
-        : Colors(colors)
+// only the packed form below ends up in flash
+constexpr TAnimation<10, 9> Animation1Source = {
     {
-        Period = 10;
-        for (unsigned int i = 0; i < NUM_LEDS; ++i) {
-            Pixels[i] = GetRandom(Colors);
-        }
-    }
-
-    virtual void Draw(TStripType& strip) override {
-        for (unsigned int i = 0; i < countof(Pixels); ++i) {
-            strip.setPixelColor(i, Pixels[i]);
-        }        
-    }
-
-    virtual void Move(TStripType& strip) override {
-        if (IsTime()) {
-            auto s = Pixels[NUM_LEDS - 1];
-            for (unsigned int i = NUM_LEDS - 1; i > 0; --i) {
-                Pixels[i] = Pixels[i - 1];
-            }
-            Pixels[0] = s;
-            UpdateTime();
-        }
-        Draw(strip);
+        {8, {0x000000, 0x000000, 0x000000, 0x000000, 0xFFFFFF, 0x000000, 0x000000, 0x000000, 0x000000}},
+        {8, {0x000000, 0x000000, 0x000000, 0xC0C0C0, 0xFFFFFF, 0xC0C0C0, 0x000000, 0x000000, 0x000000}},
+        {8, {0x000000, 0x000000, 0x000000, 0xFFFFFF, 0xC0C0C0, 0xFFFFFF, 0x000000, 0x000000, 0x000000}},
+        {5, {0x000000, 0x000000, 0xC0C0C0, 0xC0C0C0, 0x808080, 0xC0C0C0, 0xC0C0C0, 0x000000, 0x000000}},
+        {5, {0x000000, 0x000000, 0xC0C0C0, 0x808080, 0x404040, 0x808080, 0xC0C0C0, 0x000000, 0x000000}},
+        {5, {0x000000, 0x000000, 0x808080, 0x404040, 0x202020, 0x404040, 0x808080, 0x000000, 0x000000}},
+        {8, {0x000000, 0x404040, 0x202020, 0x101010, 0x080808, 0x101010, 0x202020, 0x404040, 0x000000}},
+        {8, {0x202020, 0x101010, 0x080808, 0x040404, 0x040004, 0x040404, 0x080808, 0x101010, 0x202020}},
+        {8, {0x101010, 0x080808, 0x040404, 0x040004, 0x040004, 0x000004, 0x040404, 0x080808, 0x101010}},
+        {8, {0x000000, 0x000000, 0x000000, 0x000000, 0x000000, 0x000000, 0x000000, 0x000000, 0x000000}}
     }
-
-protected:
-    const ColorsType& Colors;
 };
+constexpr auto Animation1 = PACK_ANIMATION(Animation1Source);
 
-template <typename ColorsType>
-class TRandomSelectorSmoothShifterActor : public TActor, TColorSmoother {
-    uint32_t PixelsDesired[NUM_LEDS];
-    static constexpr int MAX_SHIFT = 10;
-    int Shift = 0;
-
-public:
-    TRandomSelectorSmoothShifterActor(const ColorsType& colors)
-        : Colors(colors)
-    {
-        Period = 10;
-        for (unsigned int i = 0; i < NUM_LEDS; ++i) {
-            PixelsDesired[i] = GetRandom(Colors);
-        }
-    }
-
-    virtual void Draw(TStripType& strip) override {
-        float trans = float(Shift) / MAX_SHIFT;
-        SmoothApply(strip, PixelsDesired, trans);
-    }
+/*TPatternActor<decltype(Pattern)> PatternActor(Pattern, 1, true, 40);
+TSmoothPatternActor<decltype(Pattern)> SmoothPatternActor(Pattern, true);
+TChaoticPatternMovementActor<decltype(ChaoticPattern)> ChaoticPatternMovementActor(ChaoticPattern);
+TChaoticPatternMovementWithRandomTrailActor<decltype(ChaoticPattern)> ChaoticPatternMovementWithRandomTrailActor(ChaoticPattern);
+TRandomFillActor<> RandomFillActor;
+TRandomShifterActor<> RandomShifterActor;
+TRandomSelectorShifterActor<decltype(Colors)> RandomSelectorShifterActor(Colors);
+TRandomSelectorSmoothShifterActor<decltype(Colors)> RandomSelectorSmoothShifterActor(Colors);
+TRandomSmoothBlenderActor<decltype(Colors)> RandomSmoothBlenderActor(Colors);
+TDecayingSplashesActor<decltype(WhiteColor)> DecayingSplashesActor(1, 5, WhiteColor);
+TProportionalColorsActor<decltype(RainbowColors)> ProportionalColorsActor(RainbowColors);
+TAnimationActor<decltype(Animation1), 10> AnimationActor(Animation1);*/
 
-    virtual void Move(TStripType& strip) override {
-        if (IsTime()) {
-            Shift = (Shift + 1) % MAX_SHIFT;
-            if (Shift == 0) {
-                auto s = PixelsDesired[NUM_LEDS - 1];
-                for (unsigned int i = NUM_LEDS - 1; i > 0; --i) {
-                    PixelsDesired[i] = PixelsDesired[i - 1];
-                }
-                PixelsDesired[0] = s;
-            }
-            UpdateTime();
-        }
-        Draw(strip);
+TActor* CurrentActor = nullptr;
+uint32_t StrategyStartTime = 0;
+static constexpr uint32_t STRATEGY_TIME = 60000;
+static constexpr uint32_t BRIGHTNESS_RAMP_TIME = 500;
+static constexpr uint32_t FADE_TIME = 2000;
+static constexpr uint32_t MAX_FADE_TIME = STRATEGY_TIME;
+uint32_t FadeTime = FADE_TIME;
+TCrossfadeActor* Crossfade = nullptr;
+uint32_t PatternCopy[countof(Pattern)];
+uint32_t SingleColor[1];
+int Strategy = -1;
+bool Reseeded = false; // switches to a new strategy at once
+static const char* const StrategyNames[] = {"pattern", "splashes", "single colour splashes", "single blender", "shift colours",
+    "fast blender", "smooth shifter"};
+uint32_t last = 0;
+bool lock = false;
+TCommandLine UsbCommands(SerialUSB);
+TCommandLine Serial1Commands(Serial1);
+uint32_t MaxCommandTime = 0; // us
+TFrameReceiver Stream;
+bool Streaming = false;
+uint32_t StreamStatsFrames = 0;
+uint32_t StreamStatsTime = 0;
+
+// crossfades from the current actor to the new one, or cuts over when fading is off or fade is
+// false, which also drops a crossfade under way. name is what STATS books its frames on
+void SwitchActor(TActor* actor, const char* name, bool fade = true) {
+    Streaming = false;
+    if (actor == nullptr) {
+        SerialUSB.println("Actor arena is full");
+        return;
+    }
+    Profiler.Select(name);
+    uint32_t fadeTime = fade ? FadeTime : 0;
+    if (Crossfade != nullptr && fadeTime != 0) {
+        Crossfade->Restart(actor, Canvas, fadeTime);
+        return;
+    }
+    TCrossfadeActor* crossfade = nullptr;
+    if (CurrentActor != nullptr && fadeTime != 0) {
+        crossfade = Arena.Create<TCrossfadeActor>(CurrentActor, Canvas, actor, Canvas, fadeTime);
+    }
+    if (crossfade == nullptr) {
+        delete CurrentActor;
+        CurrentActor = actor;
+        Crossfade = nullptr;
+    } else {
+        CurrentActor = Crossfade = crossfade;
     }
+}
 
-protected:
-    const ColorsType& Colors;
+struct TNamedColor {
+    const char* Name;
+    uint32_t Color;
 };
 
-template <typename ColorsType>
-class TRandomSmoothBlenderActor : public TActor, TColorSmoother {
-    uint32_t Pixels[NUM_LEDS];
-    uint32_t PixelsDesired[NUM_LEDS];
-    static constexpr int MAX_SHIFT = 50;
-    int Shift = 0;
-
-public:
-    TRandomSmoothBlenderActor(const ColorsType& colors, TStripType& strip)
-        : Colors(colors)
-    {
-        Period = 100;
-        for (unsigned int i = 0; i < NUM_LEDS; ++i) {
-            Pixels[i] = strip.getPixelColor(i);
-            PixelsDesired[i] = GetRandom(Colors);
-        }
-    }
-
-    virtual void Draw(TStripType& strip) override {
-        float trans = float(Shift) / MAX_SHIFT;
-        for (unsigned int i = 0; i < NUM_LEDS; ++i) {
-            strip.setPixelColor(i, MergeColors(Pixels[i], PixelsDesired[i], trans));
-        }
-    }
-
-    virtual void Move(TStripType& strip) override {
-        if (IsTime()) {
-            Shift = (Shift + 1) % MAX_SHIFT;
-            if (Shift == 0) {
-                for (unsigned int i = 0; i < NUM_LEDS; ++i) {
-                    Pixels[i] = PixelsDesired[i];
-                    PixelsDesired[i] = GetRandom(Colors);
-                }
-            }
-            UpdateTime();
-        }
-        Draw(strip);
-    }
-
-protected:
-    const ColorsType& Colors;
+static const TNamedColor NamedColors[] = {
+    {"RED", 0xFF0000},
+    {"GREEN", 0x00FF00},
+    {"BLUE", 0x0000FF},
+    {"WHITE", 0xFFFFFF},
+    {"PINK", 0xFFC0CB},
 };
 
-template <typename ColorsType>
-class TRandomFastBlenderActor : public TActor, TColorSmoother {
-    uint32_t Pixels[NUM_LEDS];
-    uint32_t StartingColor;
-    uint32_t DesiredColor;
-    static constexpr int MAX_SHIFT = 50;
-    int Shift = 0;
-
-public:
-    TRandomFastBlenderActor(const ColorsType& colors, TStripType& strip)
-        : Colors(colors)
-    {
-        Period = 10;
-        DesiredColor = GetRandom(Colors);
-        for (unsigned int i = 0; i < NUM_LEDS; ++i) {
-            Pixels[i] = strip.getPixelColor(i);
-        }
-        StartingColor = Pixels[0];
-    }
-
-    virtual void Draw(TStripType& strip) override {
-        for (unsigned int i = 0; i < NUM_LEDS; ++i) {
-            strip.setPixelColor(i, Pixels[i]);
+const TNamedColor* FindNamedColor(const char* name) {
+    for (const TNamedColor& color : NamedColors) {
+        if (strcmp(name, color.Name) == 0) {
+            return &color;
         }
     }
+    return nullptr;
+}
 
-    virtual void Move(TStripType& strip) override {
-        if (IsTime()) {
-            for (unsigned int i = NUM_LEDS - 1; i > 0; --i) {
-                Pixels[i] = Pixels[i - 1];
-            }
-            Shift = (Shift + 1) % MAX_SHIFT;
-            if (Shift == 0) {
-                Pixels[0] = StartingColor = DesiredColor;
-                MakeRandom(DesiredColor, Colors);
-            } else {
-                float trans = float(Shift) / MAX_SHIFT;
-                Pixels[0] = MergeColors(StartingColor, DesiredColor, trans);
-            }
-            
-            UpdateTime();
-        }
-        Draw(strip);
-    }
-
-protected:
-    const ColorsType& Colors;
-};
-
-template <typename ColorsType>
-class TSingleRandomSmoothBlenderActor : public TActor, TColorSmoother {
-    uint32_t Pixels[NUM_LEDS];
-    uint32_t ColorDesired;
-    static constexpr int MAX_SHIFT = 250;
-    int Shift = 0;
-
-public:
-    TSingleRandomSmoothBlenderActor(const ColorsType& colors, TStripType& strip)
-        : Colors(colors)
-    {
-        Period = 10;
-        ColorDesired = GetRandom(Colors);
-        for (unsigned int i = 0; i < NUM_LEDS; ++i) {
-            Pixels[i] = strip.getPixelColor(i);
+void CommandPrint(TCommandLine&) {
+    for (unsigned int i = 0; i < NUM_LEDS; ++i) {
+        int32_t color = Canvas.Get(i);
+        SerialUSB.print(color, HEX);
+        if (i % 16 == 15) {
+            SerialUSB.println();
+        } else {
+            SerialUSB.print(' ');
         }
     }
+    SerialUSB.println();
+}
 
-    virtual void Draw(TStripType& strip) override {
-        float trans = float(Shift) / (MAX_SHIFT - 1);
-        for (unsigned int i = 0; i < NUM_LEDS; ++i) {
-            strip.setPixelColor(i, MergeColors(Pixels[i], ColorDesired, trans));
-        }
+// a named colour fades in as a gradient, 6 hex digits fill the strip
+void CommandSet(TCommandLine& line) {
+    const TNamedColor* named = FindNamedColor(line[1]);
+    if (named != nullptr) {
+        SwitchActor(Arena.Create<TSingleColorGradientActor<>>(named->Color), "gradient");
+    } else if (strlen(line[1]) == 6) {
+        SwitchActor(Arena.Create<TSingleColorActor<>>(from_hex(line[1])), "single colour");
     }
+}
 
-    virtual void Move(TStripType& strip) override {
-        if (IsTime()) {
-            Shift = (Shift + 1) % MAX_SHIFT;
-            if (Shift == 0) {
-                for (unsigned int i = 0; i < NUM_LEDS; ++i) {
-                    Pixels[i] = ColorDesired;
-                }
-                MakeRandom(ColorDesired, Colors);
-                PostponeTime(10000);
-            } else {
-                UpdateTime();
-            }
-        }
-        Draw(strip);
+void CommandBlend(TCommandLine& line) {
+    const TNamedColor* named = FindNamedColor(line[1]);
+    if (named != nullptr) {
+        SingleColor[0] = named->Color;
+    } else if (strlen(line[1]) == 6) {
+        SingleColor[0] = from_hex(line[1]);
+    } else {
+        return;
     }
+    SwitchActor(Arena.Create<TSingleRandomSmoothBlenderActor<decltype(SingleColor)>>(SingleColor, Canvas), "blend");
+}
 
-protected:
-    const ColorsType& Colors;
-};
-
-class TSingleColorGradientActor : public TActor, TColorSmoother {
-    uint32_t ColorDesired;
+// one hex digit scales to the full range, two are taken as they are
+void CommandBrightness(TCommandLine& line) {
+    int brightness = 255;
+    if (strlen(line[1]) == 1) {
+        brightness = from_hex(line[1]) * 255 / 15;
+    } else if (strlen(line[1]) == 2) {
+        brightness = from_hex(line[1]);
+    }
+    SerialUSB.print("Setting brightness to ");
+    SerialUSB.println(brightness);
+    Output.SetBrightness(brightness, BRIGHTNESS_RAMP_TIME);
+}
 
-public:
-    TSingleColorGradientActor(uint32_t color)
-        : ColorDesired(color)
-    {
+// dithering shows dim levels between whole steps, at the cost of showing every frame while they are up
+void CommandDither(TCommandLine& line) {
+    if (strcmp(line[1], "ON") == 0) {
+        Output.SetDither(true);
+    } else if (strcmp(line[1], "OFF") == 0) {
+        Output.SetDither(false);
+    } else {
+        SerialUSB.println("DITHER takes ON or OFF");
     }
+}
 
-    virtual void Draw(TStripType& strip) override {
-        for (unsigned int i = 0; i < NUM_LEDS; ++i) {
-            strip.setPixelColor(i, MergeColors(0, ColorDesired, float(i) / NUM_LEDS));
-        }
+// ms, 0 cuts over without a crossfade
+void CommandFade(TCommandLine& line) {
+    char* end;
+    long fadeTime = strtol(line[1], &end, 10);
+    if (end == line[1] || *end != 0 || fadeTime < 0 || fadeTime > long(MAX_FADE_TIME)) {
+        SerialUSB.print("FADE takes 0..");
+        SerialUSB.println(MAX_FADE_TIME);
+        return;
     }
+    FadeTime = fadeTime;
+}
 
-    virtual void Move(TStripType& strip) override {
-        if (IsTime()) {
-            UpdateTime();
-        }
-        Draw(strip);
+void CommandFps(TCommandLine& line) {
+    char* end;
+    long frameRate = strtol(line[1], &end, 10);
+    if (end == line[1] || *end != 0 || frameRate < 1 || frameRate > long(TFrameScheduler::MAX_FRAME_RATE)) {
+        SerialUSB.print("FPS takes 1..");
+        SerialUSB.println(TFrameScheduler::MAX_FRAME_RATE);
+        return;
     }
-};
+    Scheduler.SetFrameRate(frameRate);
+}
 
-template <typename ColorsType>
-class TDecayingSplashesActor : public TActor {
-public:
-    TDecayingSplashesActor(int amount, int speed, const ColorsType& colors, TStripType& strip)
-        : Amount(amount)
-        , Speed(speed)
-        , Colors(colors)
-    {
-        Period = 5;
-        for (unsigned int i = 0; i < NUM_LEDS; ++i) {
-            PixelsDesired[i].Value = strip.getPixelColor(i);
-        }
-    }
+void CommandLock(TCommandLine&) {
+    lock = true;
+}
 
-    virtual void Draw(TStripType& strip) override {
-        for (unsigned int i = 0; i < NUM_LEDS; ++i) {
-            strip.setPixelColor(i, PixelsDesired[i].Value);
-        }
-    }
+void CommandUnlock(TCommandLine&) {
+    lock = false;
+}
 
-    virtual void Move(TStripType& strip) override {
-        if (IsTime()) {
-            for (unsigned i = 0; i < NUM_LEDS; ++i) {
-                PixelsDesired[i].R -= min(PixelsDesired[i].R, Speed);
-                PixelsDesired[i].G -= min(PixelsDesired[i].G, Speed);
-                PixelsDesired[i].B -= min(PixelsDesired[i].B, Speed);
-            }
-            for (int i = 0; i < Amount; ++i) {
-                PixelsDesired[random(NUM_LEDS)].Value = GetRandom(Colors);
-            }
-            UpdateTime();
-        }
-        Draw(strip);
-    }
+void CommandStop(TCommandLine&) {
+    Streaming = false;
+    delete CurrentActor;
+    CurrentActor = nullptr;
+    Crossfade = nullptr;
+    lock = false;
+}
 
-protected:
-    TColorRGB PixelsDesired[NUM_LEDS] = {};
-    int Amount;
-    int Speed;
-    const ColorsType& Colors;
-};
+// frames received since the last STREAM, to measure what a host gets through
+void CommandStream(TCommandLine&) {
+    uint32_t now = millis();
+    uint32_t frames = Stream.Frames - StreamStatsFrames;
+    SerialUSB.print("Stream frames ");
+    SerialUSB.print(frames);
+    SerialUSB.print(", errors ");
+    SerialUSB.print(Stream.Errors);
+    SerialUSB.print(", fps ");
+    SerialUSB.println(now != StreamStatsTime ? frames * 1000.0 / (now - StreamStatsTime) : 0.0);
+    StreamStatsFrames = Stream.Frames;
+    StreamStatsTime = now;
+}
 
-class TSingleColorActor : public TActor, TColorSmoother {
-public:
-    TSingleColorActor(uint32_t color)
-        : Color(color)
-    {
-        Period = 1000;
-    }
+// refresh timing of every strip since the last STRIPS
+void CommandStrips(TCommandLine&) {
+    for (unsigned int s = 0; s < Strips.GetCount(); ++s) {
+        const TStripStats& stats = Output.GetStats(s);
+        SerialUSB.print("Strip ");
+        SerialUSB.print(s);
+        SerialUSB.print(" pin ");
+        SerialUSB.print(StripPins[s]);
+        SerialUSB.print(", shows ");
+        SerialUSB.print(stats.Shows);
+        SerialUSB.print(", average ");
+        SerialUSB.print(stats.Shows != 0 ? stats.ShowTime / stats.Shows : 0);
+        SerialUSB.print(" us, longest ");
+        SerialUSB.print(stats.MaxShowTime);
+        SerialUSB.print(" us, wire ");
+        SerialUSB.print(TStripSet::WIRE_TIME);
+        SerialUSB.println(" us");
+    }
+    Output.ResetStats();
+}
 
-    virtual void Draw(TStripType& strip) override {
-        for (unsigned int i = 0; i < NUM_LEDS; ++i) {
-            strip.setPixelColor(i, Color);
-        }
-    }
+// render timing per actor since boot or the last STATS RESET
+void CommandStats(TCommandLine&) {
+    Profiler.Print(SerialUSB);
+}
 
-    virtual void Move(TStripType& strip) override {
-        if (IsTime()) {
-            UpdateTime();
-        }
-        Draw(strip);
+void CommandStatsReset(TCommandLine& line) {
+    if (strcmp(line[1], "RESET") == 0) {
+        Profiler.Reset();
     }
+}
 
-protected:
-    uint32_t Color;
-};
-
-template <typename ColorsType>
-class TShiftRandomColorsActor : public TActor, TColorSmoother {
-public:
-    TShiftRandomColorsActor(const ColorsType& colors)
-        : Colors(colors)
-    {
-        Period = 50;
-        Color = GetRandom(Colors);
-    }
+void CommandSeed(TCommandLine&) {
+    SerialUSB.print("Seed ");
+    SerialUSB.println(TRandom::Get().GetSeed());
+}
 
-    virtual void Draw(TStripType& strip) override {
-        for (int i = 0; i < NUM_LEDS; i += Distance) {
-            if (Pos % 2 == 0) {
-                strip.setPixelColor(i + Distance / 2 + Pos / 2, Color);
-            } else {
-                strip.setPixelColor(i + Distance / 2 - Pos / 2 - 1, Color);
-            }
-        }
-    }
+// the strategies and the actors repeat what they did after the same seed, from a strategy picked
+// right away and cut over to, as the actor fading out would draw on the same random numbers
+void CommandSeedSet(TCommandLine& line) {
+    char* end;
+    errno = 0;
+    unsigned long seed = strtoul(line[1], &end, 10);
+    if (end == line[1] || *end != 0 || line[1][0] == '-' || errno == ERANGE || seed != uint32_t(seed)) {
+        SerialUSB.println("SEED takes 0..4294967295");
+        return;
+    }
+    TRandom::Get().Seed(seed);
+    Strategy = -1;
+    Reseeded = true;
+}
 
-    virtual void Move(TStripType& strip) override {
-        Draw(strip);
-        if (IsTime()) {
-            ++Pos;
-            if (Pos >= Distance) {
-                Pos = 0;
-                MakeRandom(Color, Colors);
-            }
-            UpdateTime();
-        }
-    }
+void CommandPing(TCommandLine& line) {
+    line.GetPort().write("PONG\n");
+}
 
-protected:
-    const ColorsType& Colors;
-    int Pos = 0;
-    int Distance = 50;
-    uint32_t Color;
+static const TCommand Commands[] = {
+    {"SET", 1, CommandSet, false},
+    {"BLEND", 1, CommandBlend, false},
+    {"BRIGHTNESS", 1, CommandBrightness, false},
+    {"DITHER", 1, CommandDither, false},
+    {"FADE", 1, CommandFade, false},
+    {"FPS", 1, CommandFps, false},
+    {"LOCK", 0, CommandLock, false},
+    {"UNLOCK", 0, CommandUnlock, false},
+    {"STOP", 0, CommandStop, false},
+    {"PRINT", 0, CommandPrint, false},
+    {"STREAM", 0, CommandStream, false},
+    {"STRIPS", 0, CommandStrips, false},
+    {"STATS", 0, CommandStats, false},
+    {"STATS", 1, CommandStatsReset, false},
+    {"SEED", 0, CommandSeed, false},
+    {"SEED", 1, CommandSeedSet, false},
+    {"PING", 0, CommandPing, true},
 };
 
-template <typename ColorsType>
-class TProportionalColorsActor : public TActor, TColorSmoother {
-public:
-    TProportionalColorsActor(const ColorsType& colors)
-        : Colors(colors)
-    {
-        Period = 1000;
-    }
-
-    virtual void Draw(TStripType& strip) override {
-        if (countof(Colors) > 1) {
-            float colorSize = float(NUM_LEDS) / (countof(Colors) - 1);
-            for (unsigned int i = 0; i < NUM_LEDS; ++i) {
-                unsigned int colorIndex = i / colorSize;
-                strip.setPixelColor(i, MergeColors(Colors[colorIndex], Colors[colorIndex + 1], (i - colorSize * colorIndex) / colorSize));
-            }
-        } else {
-            for (unsigned int i = 0; i < NUM_LEDS; ++i) {
-                strip.setPixelColor(i, Colors[0]);
+// runs at most one line per port and loop, every line except keepalives restarts the strategy time
+void HandleCommand(TCommandLine& line) {
+    if (Stream.IsReceiving(line.GetPort()) || !line.Read()) {
+        return;
+    }
+    uint32_t start = micros();
+    line.Split();
+    const TCommand* command = FindCommand(Commands, line);
+    if (command == nullptr || !command->Quiet) {
+        for (unsigned int i = 0; i < line.GetCount(); ++i) {
+            if (i != 0) {
+                SerialUSB.print(' ');
             }
+            SerialUSB.print(line[i]);
         }
+        SerialUSB.println();
+        StrategyStartTime = millis();
+        Scheduler.Wake();
     }
-
-    virtual void Move(TStripType& strip) override {
-        if (IsTime()) {
-            UpdateTime();
-        }
-        Draw(strip);
-    }
-
-protected:
-    const ColorsType& Colors;
-};
-
-template <typename AnimationType, int Count>
-class TAnimationActor : TActor {
-public:
-    TAnimationActor(const AnimationType& animation)
-        : Animation(animation)
-    {
-        Period = 20;
-    }
-
-    virtual void Draw(TStripType& strip) override {
-        uint32_t time = millis();
-        for (unsigned int i = 0; i < Count; ++i) {
-            int position = Positions[i];
-            const auto* image = Animations[i].GetCurrentImage(Animation, time);
-            if (image) {
-                for (unsigned int p = 0; p < Animation.GetSize(); ++p) {
-                    strip.setPixelColor(position + p, (*image)[p]);
-                }
-            }
-        }
+    if (command != nullptr) {
+        command->Handler(line);
     }
+    MaxCommandTime = max(MaxCommandTime, micros() - start);
+}
 
-    virtual void Move(TStripType& strip) override {
-        if (IsTime()) {
-            Animations[AnimationNum].Start(millis());
-            Positions[AnimationNum] = random(NUM_LEDS - Animation.GetSize() + 1);
-            AnimationNum = (AnimationNum + 1) % Count;
-            UpdateTime();
-        }
-        Draw(strip);
+// the first streamed frame cuts over to showing the stream, a live host mustn't be faded in or
+// mixed with the strategy, and the strategies stay away while frames come in
+void HandleStream(TSerialType& port) {
+    if (!Stream.Read(port)) {
+        return;
     }
-
-protected:
-    const AnimationType& Animation;
-    TAnimationPlay Animations[Count];
-    int Positions[Count];
-    int AnimationNum = 0;
-};
-
-unsigned long from_hex(String str) {
-    unsigned long v = 0;
-    for (unsigned int i = 0; i < str.length(); ++i) {
-        unsigned long l = 0;
-        char c = str[i];
-        if (c >= '0' && c <= '9') {
-            l = c - '0';
-        } else if (c >= 'A' && c <= 'F') {
-            l = c - 'A' + 0xA;
-        }
-        v <<= 4;
-        v |= l;
+    if (!Streaming) {
+        TActor* actor = Arena.Create<TStreamActor>(Stream);
+        SwitchActor(actor, "stream", false);
+        Streaming = actor != nullptr;
     }
-    return v;
+    StrategyStartTime = millis();
+    Scheduler.Wake();
 }
 
-//uint32_t Pattern[] = {0x400040, 0x800080, 0xC000C0, 0xFF00FF};
-//uint32_t Pattern[] = {0x000000, 0xFFFFFF};
-uint32_t Pattern[] = {0x000000, 0x010101, 0x101010, 0x202020, 0x404040, 0x808080, 0xC0C0C0, 0xFFFFFF, 0xFFFFFF, 0xFFFFFF,
-                      0xFFFFFF, 0xFFFFFF, 0xFFFFFF, 0xC0C0C0, 0x808080, 0x404040, 0x202020, 0x101010, 0x010101, 0x000000};
-uint32_t ChaoticPattern[] = {0x000000, 0x010101, 0x101010, 0x404040, 0x101010, 0x010101, 0x000000};
-
-//uint32_t Colors[] = {0xFF0000, 0x00FF00, 0x0000FF};
-uint32_t Colors[] = {0xFF0000, 0x00FF00, 0x0000FF, 0xFFFF00, 0x00FFFF, 0xFF00FF, /*pink*/0xFFC0CB, /*orange*/0xFFA500};
-uint32_t WhiteColor[] = {0xFFFFFF};
-uint32_t RainbowColors[] = {0xFF0000, 0xFF7F00, 0xFFFF00, 0x00FF00, 0x0000FF, 0x2E2B5F, 0x8B00FF};
-
-TAnimation<10, 9> Animation1 = {
-    {
-        {8, {0x000000, 0x000000, 0x000000, 0x000000, 0xFFFFFF, 0x000000, 0x000000, 0x000000, 0x000000}},
-        {8, {0x000000, 0x000000, 0x000000, 0xC0C0C0, 0xFFFFFF, 0xC0C0C0, 0x000000, 0x000000, 0x000000}},
-        {8, {0x000000, 0x000000, 0x000000, 0xFFFFFF, 0xC0C0C0, 0xFFFFFF, 0x000000, 0x000000, 0x000000}},
-        {5, {0x000000, 0x000000, 0xC0C0C0, 0xC0C0C0, 0x808080, 0xC0C0C0, 0xC0C0C0, 0x000000, 0x000000}},
-        {5, {0x000000, 0x000000, 0xC0C0C0, 0x808080, 0x404040, 0x808080, 0xC0C0C0, 0x000000, 0x000000}},
-        {5, {0x000000, 0x000000, 0x808080, 0x404040, 0x202020, 0x404040, 0x808080, 0x000000, 0x000000}},
-        {8, {0x000000, 0x404040, 0x202020, 0x101010, 0x080808, 0x101010, 0x202020, 0x404040, 0x000000}},
-        {8, {0x202020, 0x101010, 0x080808, 0x040404, 0x040004, 0x040404, 0x080808, 0x101010, 0x202020}},
-        {8, {0x101010, 0x080808, 0x040404, 0x040004, 0x040004, 0x000004, 0x040404, 0x080808, 0x101010}},
-        {8, {0x000000, 0x000000, 0x000000, 0x000000, 0x000000, 0x000000, 0x000000, 0x000000, 0x000000}}
-    }
-};
-
-/*TPatternActor<decltype(Pattern)> PatternActor(Pattern, 1, true, 40);
-TSmoothPatternActor<decltype(Pattern)> SmoothPatternActor(Pattern, true);
-TChaoticPatternMovementActor<decltype(ChaoticPattern)> ChaoticPatternMovementActor(ChaoticPattern);
-TChaoticPatternMovementWithRandomTrailActor<decltype(ChaoticPattern)> ChaoticPatternMovementWithRandomTrailActor(ChaoticPattern);
-TRandomFillActor RandomFillActor;
-TRandomShifterActor RandomShifterActor;
-TRandomSelectorShifterActor<decltype(Colors)> RandomSelectorShifterActor(Colors);
-TRandomSelectorSmoothShifterActor<decltype(Colors)> RandomSelectorSmoothShifterActor(Colors);
-TRandomSmoothBlenderActor<decltype(Colors)> RandomSmoothBlenderActor(Colors);
-TDecayingSplashesActor<decltype(WhiteColor)> DecayingSplashesActor(1, 5, WhiteColor);
-TProportionalColorsActor<decltype(RainbowColors)> ProportionalColorsActor(RainbowColors);
-TAnimationActor<decltype(Animation1), 10> AnimationActor(Animation1);*/
-
-TActor* CurrentActor = nullptr;
-uint32_t StrategyStartTime = 0;
-static constexpr uint32_t STRATEGY_TIME = 60000;
-decltype(Pattern) PatternCopy;
-uint32_t SingleColor[1];
-int Strategy = -1;
-uint32_t last = 0;
-String cmd;
-bool lock = false;
-
 void loop() {
     unsigned long now = millis();
-    if ((now > StrategyStartTime + STRATEGY_TIME || CurrentActor == nullptr) && !lock) {
-        int choice;
-        do {
-            choice = random(7);
-        } while (choice == Strategy);
+    if ((now > StrategyStartTime + STRATEGY_TIME || CurrentActor == nullptr || Reseeded) && !lock) {
+        // any strategy but the current one
+        int choice = RandomBelow(Strategy < 0 ? countof(StrategyNames) : countof(StrategyNames) - 1);
+        if (Strategy >= 0 && choice >= Strategy) {
+            ++choice;
+        }
+        SerialUSB.print("Frames ");
+        SerialUSB.print(Scheduler.Frames);
+        SerialUSB.print(", overruns ");
+        SerialUSB.print(Scheduler.Overruns);
+        SerialUSB.print(", heap allocations after boot ");
+        SerialUSB.print(GetHeapAllocations() - BootHeapAllocations);
+        SerialUSB.print(", slowest command ");
+        SerialUSB.print(MaxCommandTime);
+        SerialUSB.println(" us");
+        Scheduler.ResetCounters();
+        MaxCommandTime = 0;
         SerialUSB.print("Switching to strategy ");
         SerialUSB.println(choice);
         Strategy = choice;
-        delete CurrentActor;
+        TActor* actor = nullptr;
+        const char* name = StrategyNames[Strategy];
         switch(Strategy) {
             case 0:
                 TColorSmoother::MaskPattern(Pattern, PatternCopy, GetRandom(Colors));
-                CurrentActor = new TPatternActor<decltype(PatternCopy)>(PatternCopy, 1, true, 40);
+                actor = Arena.Create<TPatternActor<decltype(PatternCopy)>>(PatternCopy, 1, true, 40);
                 break;
             case 1:
-                CurrentActor = new TDecayingSplashesActor<decltype(Colors)>(1, 5, Colors, Strip);
+                actor = Arena.Create<TDecayingSplashesActor<decltype(Colors)>>(1, 5, Colors);
                 break;
             case 2:
                 MakeRandom(SingleColor[0], Colors);
-                CurrentActor = new TDecayingSplashesActor<decltype(SingleColor)>(1, 5, SingleColor, Strip);
+                actor = Arena.Create<TDecayingSplashesActor<decltype(SingleColor)>>(1, 5, SingleColor);
                 break;
             case 3:
-                CurrentActor = new TSingleRandomSmoothBlenderActor<decltype(Colors)>(Colors, Strip);
+                actor = Arena.Create<TSingleRandomSmoothBlenderActor<decltype(Colors)>>(Colors, Canvas);
                 break;
             case 4:
-                CurrentActor = new TShiftRandomColorsActor<decltype(Colors)>(Colors);
+                actor = Arena.Create<TShiftRandomColorsActor<decltype(Colors)>>(Colors);
                 break;
             case 5:
-                CurrentActor = new TRandomFastBlenderActor<decltype(Colors)>(Colors, Strip);
+                actor = Arena.Create<TRandomFastBlenderActor<decltype(Colors)>>(Colors, Canvas);
                 break;
             default:
-                CurrentActor = new TRandomSelectorSmoothShifterActor<decltype(Colors)>(Colors);
+                actor = Arena.Create<TRandomSelectorSmoothShifterActor<decltype(Colors)>>(Colors);
                 break;
         }
-        
-        StrategyStartTime = now;
-    }
-    CurrentActor->Move(Strip);
-    //RandomSmoothBlenderActor.Move(Strip);
-    //RandomSelectorShifterActor.Move(Strip);
-    //RandomSelectorSmoothShifterActor.Move(Strip);
-    //PatternActor.Move(Strip);
-    //ChaoticPatternMovementActor.Move(Strip);
-    //ChaoticPatternMovementWithRandomTrailActor.Move(Strip);
-    //PatternActor.Move(Strip);
-    //DecayingSplashesActor.Move(Strip);
-    //ProportionalColorsActor.Move(Strip);
-    //AnimationActor.Move(Strip);
-    Strip.show();
-    while (SerialUSB.available()) {
-        cmd += char(SerialUSB.read());
-        if (cmd.endsWith("\n")) {
-            break;
-        }
-    }
-    if (Serial1.available()) {
-        while (Serial1.available()) {
-            cmd += char(Serial1.read());
-            if (cmd.endsWith("\n")) {
-                break;
-            }
-        }
-        if (cmd == "PING\n") {
-            Serial1.write("PONG\n");
-            cmd = "";
-        }
-    }
-    if (cmd.endsWith("\n") || cmd.endsWith("\r")) {
-        cmd.trim();
-        SerialUSB.println(cmd);
-        if (cmd == "PRINT") {
-            for (unsigned int i = 0; i < NUM_LEDS; ++i) {
-                int32_t color = Strip.getPixelColor(i);
-                SerialUSB.print(color, HEX);
-                if (i % 16 == 15) {
-                    SerialUSB.println();
-                } else {
-                    SerialUSB.print(' ');
-                }
-            }
-            SerialUSB.println();
-        }
-        if (cmd == "BLEND RED") {
-            delete CurrentActor;
-            SingleColor[0] = 0xFF0000;
-            CurrentActor = new TSingleRandomSmoothBlenderActor<decltype(SingleColor)>(SingleColor, Strip);
-        }
-        if (cmd == "BLEND GREEN") {
-            delete CurrentActor;
-            SingleColor[0] = 0x00FF00;
-            CurrentActor = new TSingleRandomSmoothBlenderActor<decltype(SingleColor)>(SingleColor, Strip);
-        }
-        if (cmd == "BLEND BLUE") {
-            delete CurrentActor;
-            SingleColor[0] = 0x0000FF;
-            CurrentActor = new TSingleRandomSmoothBlenderActor<decltype(SingleColor)>(SingleColor, Strip);
-        }
-        if (cmd == "BLEND WHITE") {
-            delete CurrentActor;
-            SingleColor[0] = 0xFFFFFF;
-            CurrentActor = new TSingleRandomSmoothBlenderActor<decltype(SingleColor)>(SingleColor, Strip);
-        }
-        if (cmd == "BLEND PINK") {
-            delete CurrentActor;
-            SingleColor[0] = 0xFFC0CB;
-            CurrentActor = new TSingleRandomSmoothBlenderActor<decltype(SingleColor)>(SingleColor, Strip);
-        }
-        if (cmd == "SET RED") {
-            delete CurrentActor;
-            CurrentActor = new TSingleColorGradientActor(0xFF0000);
-        }
-        if (cmd == "SET GREEN") {
-            delete CurrentActor;
-            CurrentActor = new TSingleColorGradientActor(0x00FF00);
-        }
-        if (cmd == "SET BLUE") {
-            delete CurrentActor;
-            CurrentActor = new TSingleColorGradientActor(0x0000FF);
-        }
-        if (cmd == "SET WHITE") {
-            delete CurrentActor;
-            CurrentActor = new TSingleColorGradientActor(0xFFFFFF);
-        }
-        if (cmd == "SET PINK") {
-            delete CurrentActor;
-            CurrentActor = new TSingleColorGradientActor(0xFFC0CB);
-        }
-        if (cmd == "LOCK") {
-            lock = true;
-        }
-        if (cmd == "UNLOCK") {
-            lock = false;
-        }
-        if (cmd == "STOP") {
-            delete CurrentActor;
-            CurrentActor = nullptr;
-            lock = false;
-        }
-        if (cmd.startsWith("SET ")) {
-            cmd = cmd.substring(4);
-            if (cmd.length() == 6) {
-                delete CurrentActor;
-                CurrentActor = new TSingleColorActor(from_hex(cmd));
-            }
-        }
-        if (cmd.startsWith("BLEND ")) {
-            cmd = cmd.substring(6);
-            if (cmd.length() == 6) {
-                delete CurrentActor;
-                SingleColor[0] = from_hex(cmd);
-                CurrentActor = new TSingleRandomSmoothBlenderActor<decltype(SingleColor)>(SingleColor, Strip);
-            }
-        }
-        if (cmd.startsWith("BRIGHTNESS ")) {
-            cmd = cmd.substring(11);
-            int brightness = 255;
-            if (cmd.length() == 1) {
-                brightness = from_hex(cmd) * 255 / 15;
-            } else if (cmd.length() == 2) {
-                brightness = from_hex(cmd);
-            }
-            SerialUSB.print("Setting brightness to ");
-            SerialUSB.println(brightness);
-            Strip.setBrightness(brightness);
-        }
-        cmd = "";
+        SwitchActor(actor, name, !Reseeded);
+        Reseeded = false;
         StrategyStartTime = now;
+        Scheduler.Wake();
+    }
+    if (CurrentActor != nullptr && Scheduler.IsFrameTime(micros())) {
+        Profiler.BeginFrame();
+        // one timestamp for the whole frame, every actor in it moves to the same moment
+        uint32_t frameTime = millis();
+        bool changed = CurrentActor->Move(Canvas, frameTime);
+        Profiler.EndMove();
+        //RandomSmoothBlenderActor.Move(Canvas);
+        //RandomSelectorShifterActor.Move(Canvas);
+        //RandomSelectorSmoothShifterActor.Move(Canvas);
+        //PatternActor.Move(Canvas);
+        //ChaoticPatternMovementActor.Move(Canvas);
+        //ChaoticPatternMovementWithRandomTrailActor.Move(Canvas);
+        //PatternActor.Move(Canvas);
+        //DecayingSplashesActor.Move(Canvas);
+        //ProportionalColorsActor.Move(Canvas);
+        //AnimationActor.Move(Canvas);
+        if (changed || Output.IsRamping() || Output.IsDithering()) {
+            Output.Show(Canvas);
+            Profiler.EndShow();
+        }
+        if (Crossfade != nullptr && Crossfade->IsDone()) {
+            // the canvas now holds exactly what the incoming actor drew, it carries on from there
+            CurrentActor = Crossfade->ReleaseTo();
+            delete Crossfade;
+            Crossfade = nullptr;
+        }
+        uint32_t overruns = Scheduler.Overruns;
+        Scheduler.EndFrame(micros(), Output.IsRamping() || Output.IsDithering() ? 0 : CurrentActor->GetIdleTime(frameTime));
+        Profiler.EndFrame(Scheduler.Overruns != overruns);
+    }
+    HandleStream(SerialUSB);
+    HandleStream(Serial1);
+    HandleCommand(UsbCommands);
+    HandleCommand(Serial1Commands);
+    if (!SerialUSB.available() && !Serial1.available()) {
+        Scheduler.Idle();
     }
 }
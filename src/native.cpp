@@ -0,0 +1,138 @@
+#ifndef ARDUINO
+
+#include <chrono>
+#include <unistd.h>
+#include "platform.h"
+#include "strips.h"
+
+TVirtualClock Clock;
+uint32_t Entropy = 0;
+TSimulatedSerial SerialUSB(stdout);
+TSimulatedSerial Serial1(stdout);
+
+void TSimulatedStrip::setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b) {
+    if (n < numPixels()) {
+        if (Brightness) {
+            r = (r * Brightness) >> 8;
+            g = (g * Brightness) >> 8;
+            b = (b * Brightness) >> 8;
+        }
+        uint8_t* p = &Pixels[n * 3];
+        p[ROffset] = r;
+        p[GOffset] = g;
+        p[BOffset] = b;
+    }
+}
+
+void TSimulatedStrip::setPixelColor(uint16_t n, uint32_t c) {
+    setPixelColor(n, uint8_t(c >> 16), uint8_t(c >> 8), uint8_t(c));
+}
+
+uint32_t TSimulatedStrip::getPixelColor(uint16_t n) const {
+    if (n >= numPixels()) {
+        return 0;
+    }
+    const uint8_t* p = &Pixels[n * 3];
+    if (Brightness) {
+        return (((uint32_t(p[ROffset]) << 8) / Brightness) << 16)
+            | (((uint32_t(p[GOffset]) << 8) / Brightness) << 8)
+            | ((uint32_t(p[BOffset]) << 8) / Brightness);
+    }
+    return (uint32_t(p[ROffset]) << 16) | (uint32_t(p[GOffset]) << 8) | p[BOffset];
+}
+
+#ifndef LED300_BENCH
+
+extern TStripSet Strips;
+
+static void Usage(const char* name) {
+    fprintf(stderr,
+        "usage: %s [-n loops] [-t us_per_loop] [-s seed] [-c command]... [-f file]... [-p] [-q]\n"
+        "  -n  number of loop() iterations to run (default 10000)\n"
+        "  -t  virtual time advanced after each loop() in microseconds (default 1000)\n"
+        "  -s  random seed\n"
+        "  -c  command queued on SerialUSB before the first loop(), may be repeated\n"
+        "  -f  file whose bytes are queued on SerialUSB, e.g. binary frames, may be repeated\n"
+        "  -p  print the last shown frame\n"
+        "  -q  discard serial output\n",
+        name);
+}
+
+static bool FeedFile(const char* name) {
+    FILE* file = fopen(name, "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    uint8_t buffer[4096];
+    size_t size;
+    while ((size = fread(buffer, 1, sizeof(buffer), file)) != 0) {
+        SerialUSB.Feed(buffer, size);
+    }
+    fclose(file);
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    unsigned long loops = 10000;
+    unsigned long step = 1000;
+    bool printFrame = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:t:s:c:f:pqh")) != -1) {
+        switch (opt) {
+            case 'n':
+                loops = strtoul(optarg, nullptr, 10);
+                break;
+            case 't':
+                step = strtoul(optarg, nullptr, 10);
+                break;
+            case 's':
+                Entropy = strtoul(optarg, nullptr, 10);
+                break;
+            case 'c':
+                SerialUSB.Feed(optarg);
+                SerialUSB.Feed("\n");
+                break;
+            case 'f':
+                if (!FeedFile(optarg)) {
+                    fprintf(stderr, "can't read %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'p':
+                printFrame = true;
+                break;
+            case 'q':
+                SerialUSB = TSimulatedSerial(nullptr);
+                Serial1 = TSimulatedSerial(nullptr);
+                break;
+            default:
+                Usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    setup();
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned long i = 0; i < loops; ++i) {
+        loop();
+        Clock.Advance(step);
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    if (printFrame) {
+        unsigned int n = 0;
+        for (unsigned int s = 0; s < Strips.GetCount(); ++s) {
+            for (unsigned int i = 0; i < Strips[s].numPixels(); ++i, ++n) {
+                printf("%06X%c", Strips[s].GetShownColor(i), n % 16 == 15 ? '\n' : ' ');
+            }
+        }
+        printf("\n");
+    }
+    fprintf(stderr, "%lu loops, %u shows, %llu sleeps, %llu ms virtual, %.0f ns/loop\n",
+        loops, Strips[0].ShowCount, (unsigned long long)Clock.Sleeps, (unsigned long long)(Clock.Micros / 1000), loops ? double(elapsed) / loops : 0.0);
+    return 0;
+}
+
+#endif
+
+#endif
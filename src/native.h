@@ -0,0 +1,281 @@
+#pragma once
+
+// Host stand-ins for the parts of the Arduino core and the NeoPixel library the firmware uses,
+// so actors and the strategy switcher can run on a PC against a virtual clock.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#define DEC 10
+#define HEX 16
+
+#define NEO_GRB ((1 << 6) | (1 << 4) | (0 << 2) | (2))
+#define NEO_KHZ800 0x0000
+
+template <typename A, typename B>
+typename std::common_type<A, B>::type min(A a, B b) {
+    return a < b ? a : b;
+}
+
+template <typename A, typename B>
+typename std::common_type<A, B>::type max(A a, B b) {
+    return a > b ? a : b;
+}
+
+// same semantics as WMath.cpp of the SAMD core
+inline long random(long howbig) {
+    if (howbig == 0) {
+        return 0;
+    }
+    return rand() % howbig;
+}
+
+inline long random(long howsmall, long howbig) {
+    if (howsmall >= howbig) {
+        return howsmall;
+    }
+    return random(howbig - howsmall) + howsmall;
+}
+
+inline void randomSeed(unsigned long seed) {
+    if (seed != 0) {
+        srand(seed);
+    }
+}
+
+// fixed so that runs repeat, -s sets it
+extern uint32_t Entropy;
+
+inline uint32_t GetEntropy() {
+    return Entropy;
+}
+
+class TVirtualClock {
+public:
+    uint64_t Micros = 0;
+    uint64_t Sleeps = 0;
+
+    void Advance(uint64_t micros) {
+        Micros += micros;
+    }
+};
+
+extern TVirtualClock Clock;
+
+inline uint32_t millis() {
+    return Clock.Micros / 1000;
+}
+
+inline uint32_t micros() {
+    return Clock.Micros;
+}
+
+inline void delay(unsigned long ms) {
+    Clock.Advance(ms * 1000);
+}
+
+// the driver advances the clock, sleeping is only counted
+inline void WaitForInterrupt() {
+    ++Clock.Sleeps;
+}
+
+class TSimulatedSerial {
+public:
+    TSimulatedSerial(FILE* output)
+        : Output(output)
+    {}
+
+    void begin(unsigned long baud) {
+        Baud = baud;
+    }
+
+    int available() const {
+        return Input.size() - Position;
+    }
+
+    int peek() const {
+        if (Position >= Input.size()) {
+            return -1;
+        }
+        return static_cast<unsigned char>(Input[Position]);
+    }
+
+    int read() {
+        if (Position >= Input.size()) {
+            return -1;
+        }
+        return static_cast<unsigned char>(Input[Position++]);
+    }
+
+    // queues bytes as if the host had sent them
+    void Feed(const char* data) {
+        Input.append(data);
+    }
+
+    void Feed(const uint8_t* data, size_t size) {
+        Input.append(reinterpret_cast<const char*>(data), size);
+    }
+
+    size_t write(const char* str) {
+        return Put(str, strlen(str));
+    }
+
+    size_t write(uint8_t c) {
+        return Put(reinterpret_cast<const char*>(&c), 1);
+    }
+
+    size_t print(const char* str) {
+        return write(str);
+    }
+
+    size_t print(char c) {
+        return Put(&c, 1);
+    }
+
+    size_t print(double value, int digits = 2) {
+        char buffer[32];
+        return Put(buffer, snprintf(buffer, sizeof(buffer), "%.*f", digits, value));
+    }
+
+    template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+    size_t print(T value, int base = DEC) {
+        char buffer[72];
+        char* p = buffer + sizeof(buffer);
+        bool negative = base == DEC && value < 0;
+        // like Print::print(long, int), non-decimal bases print the unsigned representation
+        auto v = static_cast<typename std::make_unsigned<T>::type>(value);
+        if (negative) {
+            v = -v;
+        }
+        do {
+            auto digit = v % base;
+            *--p = digit < 10 ? '0' + digit : 'A' + digit - 10;
+            v /= base;
+        } while (v != 0);
+        if (negative) {
+            *--p = '-';
+        }
+        return Put(p, buffer + sizeof(buffer) - p);
+    }
+
+    size_t println() {
+        return write("\r\n");
+    }
+
+    template <typename... Args>
+    size_t println(Args... args) {
+        size_t n = print(args...);
+        return n + println();
+    }
+
+    unsigned long Baud = 0;
+
+protected:
+    FILE* Output;
+    std::string Input;
+    size_t Position = 0;
+
+    size_t Put(const char* data, size_t size) {
+        if (Output) {
+            fwrite(data, 1, size, Output);
+        }
+        return size;
+    }
+};
+
+extern TSimulatedSerial SerialUSB;
+extern TSimulatedSerial Serial1;
+
+// in-memory framebuffer with the pixel storage and brightness semantics of Adafruit_NeoPixel
+class TSimulatedStrip {
+public:
+    TSimulatedStrip(uint16_t n, int16_t pin, uint16_t type)
+        : Pin(pin)
+        , Pixels(n * 3)
+        , Shown(n * 3)
+        , ROffset((type >> 4) & 0x3)
+        , GOffset((type >> 2) & 0x3)
+        , BOffset(type & 0x3)
+    {}
+
+    bool begin() {
+        return true;
+    }
+
+    void show() {
+        Shown = Pixels;
+        ++ShowCount;
+    }
+
+    bool canShow() const {
+        return true;
+    }
+
+    uint16_t numPixels() const {
+        return Pixels.size() / 3;
+    }
+
+    uint8_t* getPixels() {
+        return Pixels.data();
+    }
+
+    void clear() {
+        std::fill(Pixels.begin(), Pixels.end(), 0);
+    }
+
+    // out of line like in the library, so per pixel calls cost a real call
+    void setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b);
+    void setPixelColor(uint16_t n, uint32_t c);
+    uint32_t getPixelColor(uint16_t n) const;
+
+    // rescales the stored pixels the same lossy way the library does
+    void setBrightness(uint8_t b) {
+        uint8_t newBrightness = b + 1;
+        if (newBrightness != Brightness) {
+            uint8_t oldBrightness = Brightness - 1;
+            uint16_t scale;
+            if (oldBrightness == 0) {
+                scale = 0;
+            } else if (b == 255) {
+                scale = 65535 / oldBrightness;
+            } else {
+                scale = ((uint16_t(newBrightness) << 8) - 1) / oldBrightness;
+            }
+            for (auto& c : Pixels) {
+                c = (c * scale) >> 8;
+            }
+            Brightness = newBrightness;
+        }
+    }
+
+    uint8_t getBrightness() const {
+        return Brightness - 1;
+    }
+
+    // colour of a pixel as it was latched by the last show()
+    uint32_t GetShownColor(uint16_t n) const {
+        const uint8_t* p = &Shown[n * 3];
+        return (uint32_t(p[ROffset]) << 16) | (uint32_t(p[GOffset]) << 8) | p[BOffset];
+    }
+
+    int16_t Pin;
+    uint32_t ShowCount = 0;
+
+protected:
+    std::vector<uint8_t> Pixels;
+    std::vector<uint8_t> Shown;
+    uint8_t ROffset;
+    uint8_t GOffset;
+    uint8_t BOffset;
+    uint8_t Brightness = 0;
+};
+
+void setup();
+void loop();
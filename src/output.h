@@ -0,0 +1,176 @@
+#pragma once
+
+#include "platform.h"
+#include "canvas.h"
+#include "strips.h"
+
+// gamma 2.6 with 16 bit precision, 65535 is full on
+static const uint16_t Gamma16[256] = {
+        0,     0,     0,     1,     1,     2,     4,     6,     8,    11,    14,    18,    23,    29,    35,    41,
+       49,    57,    67,    77,    88,    99,   112,   126,   141,   156,   173,   191,   210,   230,   251,   274,
+      297,   322,   348,   375,   404,   433,   464,   497,   531,   566,   602,   640,   680,   721,   763,   807,
+      853,   899,   948,   998,  1050,  1103,  1158,  1215,  1273,  1333,  1394,  1458,  1523,  1590,  1658,  1729,
+     1801,  1875,  1951,  2029,  2109,  2190,  2274,  2359,  2446,  2536,  2627,  2720,  2816,  2913,  3012,  3114,
+     3217,  3323,  3431,  3541,  3653,  3767,  3883,  4001,  4122,  4245,  4370,  4498,  4627,  4759,  4893,  5030,
+     5169,  5310,  5453,  5599,  5747,  5898,  6051,  6206,  6364,  6525,  6688,  6853,  7021,  7191,  7364,  7539,
+     7717,  7897,  8080,  8266,  8454,  8645,  8838,  9034,  9233,  9434,  9638,  9845, 10055, 10267, 10482, 10699,
+    10920, 11143, 11369, 11598, 11829, 12064, 12301, 12541, 12784, 13030, 13279, 13530, 13785, 14042, 14303, 14566,
+    14832, 15102, 15374, 15649, 15928, 16209, 16493, 16781, 17071, 17365, 17661, 17961, 18264, 18570, 18879, 19191,
+    19507, 19825, 20147, 20472, 20800, 21131, 21466, 21804, 22145, 22489, 22837, 23188, 23542, 23899, 24260, 24625,
+    24992, 25363, 25737, 26115, 26496, 26880, 27268, 27659, 28054, 28452, 28854, 29259, 29667, 30079, 30495, 30914,
+    31337, 31763, 32192, 32626, 33062, 33503, 33947, 34394, 34846, 35300, 35759, 36221, 36687, 37156, 37629, 38106,
+    38586, 39071, 39558, 40050, 40545, 41045, 41547, 42054, 42565, 43079, 43597, 44119, 44644, 45174, 45707, 46245,
+    46786, 47331, 47880, 48432, 48989, 49550, 50114, 50683, 51255, 51832, 52412, 52996, 53585, 54177, 54773, 55374,
+    55978, 56587, 57199, 57816, 58436, 59061, 59690, 60323, 60960, 61601, 62246, 62896, 63549, 64207, 64869, 65535
+};
+
+// Turns the full precision canvas into strip bytes through one combined gamma and brightness table,
+// changing the brightness rebuilds the 256 entries of the table instead of rescaling pixels.
+// The table keeps 8 fractional bits. They are rounded off unless dithering is on, then temporal
+// dithering turns them into frames one step apart: a level of 2.25 shows 3 one frame in four.
+// Every strip gets its own part of the canvas and is started as soon as its bytes are ready.
+class TOutputStage {
+public:
+    static constexpr unsigned int R_OFFSET = (STRIP_TYPE >> 4) & 0x3;
+    static constexpr unsigned int G_OFFSET = (STRIP_TYPE >> 2) & 0x3;
+    static constexpr unsigned int B_OFFSET = STRIP_TYPE & 0x3;
+    // 8.8 levels below this with a fraction flicker visibly unless they are shown every frame
+    static constexpr uint32_t DITHER_LIMIT = 8 << 8;
+
+    TOutputStage(TStripSet& strips)
+        : Strips(strips)
+    {
+        Rebuild();
+    }
+
+    // brightness 0-255, changed linearly over rampTime ms
+    void SetBrightness(uint8_t brightness, uint32_t rampTime = 0) {
+        RampFrom = Brightness;
+        RampTo = brightness << 8;
+        RampStart = millis();
+        RampTime = rampTime;
+        if (RampTime == 0) {
+            Brightness = RampTo;
+            Rebuild();
+        }
+    }
+
+    uint8_t GetBrightness() const {
+        return Brightness >> 8;
+    }
+
+    bool IsRamping() const {
+        return Brightness != RampTo;
+    }
+
+    // off by default, dithered dim levels need every frame shown, so the main loop doesn't idle
+    // while they are up
+    void SetDither(bool dither) {
+        Dither = dither;
+    }
+
+    bool GetDither() const {
+        return Dither;
+    }
+
+    // the last frame had dim levels that only come out right while frames keep being shown
+    bool IsDithering() const {
+        return Dithering;
+    }
+
+    // 8.8 fixed point output level of a channel value
+    uint16_t GetLevel(uint8_t value) const {
+        return Table[value];
+    }
+
+    void Show(const TCanvas& canvas) {
+        if (IsRamping()) {
+            UpdateRamp();
+        }
+        // the bit reversed frame count spreads the lit frames of a level evenly, every pixel starts
+        // somewhere else in the sequence so that dim pixels don't blink together; without dithering
+        // a constant half step rounds
+        uint8_t dither = Dither ? Reverse(++Frame) : 0x80;
+        uint8_t spread = Dither ? 0x4F : 0;
+        bool dithering = false;
+        const uint32_t* colors = canvas.GetPixels();
+        for (unsigned int s = 0; s < Strips.GetCount(); ++s) {
+            uint32_t start = micros();
+            uint8_t* p = Strips[s].getPixels();
+            for (unsigned int i = 0; i < STRIP_LENGTH; ++i, p += 3) {
+                uint32_t color = *colors++;
+                uint32_t r = Table[(color >> 16) & 0xFF];
+                uint32_t g = Table[(color >> 8) & 0xFF];
+                uint32_t b = Table[color & 0xFF];
+                p[R_OFFSET] = (r + dither) >> 8;
+                p[G_OFFSET] = (g + dither) >> 8;
+                p[B_OFFSET] = (b + dither) >> 8;
+                dithering |= IsFlickering(r) | IsFlickering(g) | IsFlickering(b);
+                dither += spread;
+            }
+            Strips[s].show();
+            uint32_t time = micros() - start;
+            TStripStats& stats = Stats[s];
+            ++stats.Shows;
+            stats.ShowTime += time;
+            stats.MaxShowTime = max(stats.MaxShowTime, time);
+        }
+        Dithering = Dither && dithering;
+    }
+
+    const TStripStats& GetStats(unsigned int strip) const {
+        return Stats[strip];
+    }
+
+    void ResetStats() {
+        for (TStripStats& stats : Stats) {
+            stats = TStripStats();
+        }
+    }
+
+    static uint8_t Reverse(uint8_t value) {
+        value = (value & 0xF0) >> 4 | (value & 0x0F) << 4;
+        value = (value & 0xCC) >> 2 | (value & 0x33) << 2;
+        return (value & 0xAA) >> 1 | (value & 0x55) << 1;
+    }
+
+protected:
+    TStripSet& Strips;
+    TStripStats Stats[STRIP_COUNT];
+    uint16_t Table[256]; // 8.8 fixed point
+    uint16_t Brightness = 0xFF00; // 8.8 fixed point
+    uint16_t RampFrom = 0xFF00;
+    uint16_t RampTo = 0xFF00;
+    uint32_t RampStart = 0;
+    uint32_t RampTime = 0;
+    uint8_t Frame = 0;
+    bool Dither = false;
+    bool Dithering = false;
+
+    static bool IsFlickering(uint32_t level) {
+        return (level & 0xFF) != 0 && level < DITHER_LIMIT;
+    }
+
+    void UpdateRamp() {
+        uint32_t elapsed = millis() - RampStart;
+        uint16_t brightness = RampTo;
+        if (elapsed < RampTime) {
+            brightness = RampFrom + (int32_t(RampTo) - int32_t(RampFrom)) * int32_t(elapsed) / int32_t(RampTime);
+        }
+        if (brightness != Brightness) {
+            Brightness = brightness;
+            Rebuild();
+        }
+    }
+
+    // gamma 0xFFFF counts as 0x10000, so full on is exactly Brightness and never dithers; a channel
+    // that isn't 0 stays lit at a steady step or more as long as the brightness isn't 0, dithering
+    // below one step would only blink
+    void Rebuild() {
+        Table[0] = 0;
+        for (unsigned int i = 1; i < 256; ++i) {
+            uint32_t gamma = Gamma16[i] + (Gamma16[i] >> 15);
+            Table[i] = max((gamma * Brightness + 0x8000) >> 16, Brightness != 0 ? 0x100u : 0u);
+        }
+    }
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "platform.h"
+#include "canvas.h"
+
+// Circular pixel storage: rotating it only moves the head, the rotation is resolved once
+// when the pixels are written out to the canvas. With an 8 bit PixelType it holds palette
+// indices, which only become colours when drawn with the palette.
+template <unsigned int Size, typename PixelType = uint32_t>
+class TPixelRing {
+public:
+    static constexpr unsigned int GetSize() {
+        return Size;
+    }
+
+    PixelType& operator [](unsigned int index) {
+        return Pixels[GetOffset(index)];
+    }
+
+    PixelType operator [](unsigned int index) const {
+        return Pixels[GetOffset(index)];
+    }
+
+    // every pixel moves one position up, the last one wraps around to position 0
+    void RotateUp() {
+        Head = (Head == 0 ? Size : Head) - 1;
+    }
+
+    // calls func(index, color) for all pixels in order, without any per pixel wrapping
+    template <typename FuncType>
+    void ForEach(FuncType func) const {
+        unsigned int index = 0;
+        for (unsigned int p = Head; p < Size; ++p) {
+            func(index++, Pixels[p]);
+        }
+        for (unsigned int p = 0; p < Head; ++p) {
+            func(index++, Pixels[p]);
+        }
+    }
+
+    template <unsigned int Length>
+    void Draw(TCanvasOf<Length>& canvas) const {
+        static_assert(Size <= Length, "pixels don't fit the canvas");
+        canvas.Write(0, Pixels + Head, Size - Head);
+        canvas.Write(Size - Head, Pixels, Head);
+    }
+
+    template <unsigned int Length, typename PaletteType>
+    void Draw(TCanvasOf<Length>& canvas, const PaletteType& palette) const {
+        static_assert(Size <= Length, "pixels don't fit the canvas");
+        uint32_t* pixels = canvas.GetPixels();
+        ForEach([&](unsigned int index, PixelType pixel) {
+            pixels[index] = palette[pixel];
+        });
+    }
+
+    template <unsigned int Length>
+    void Read(const TCanvasOf<Length>& canvas) {
+        Head = 0;
+        canvas.Read(0, Pixels, Size);
+    }
+
+protected:
+    PixelType Pixels[Size] = {};
+    unsigned int Head = 0;
+
+    unsigned int GetOffset(unsigned int index) const {
+        index += Head;
+        return index < Size ? index : index - Size;
+    }
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+// the strip configuration can be set with -D in the build_flags of platformio.ini
+#ifndef STRIP_PINS
+#define STRIP_PINS 5 // one pin per strip, comma separated, on the board each needs its own SERCOM
+#endif
+#ifndef STRIP_COUNT
+#define STRIP_COUNT 1
+#endif
+#ifndef STRIP_LENGTH
+#define STRIP_LENGTH 300 // LEDs per strip
+#endif
+#ifndef NUM_LEDS
+#define NUM_LEDS (STRIP_COUNT * STRIP_LENGTH) // the canvas runs through the strips in pin order
+#endif
+#ifndef FRAME_RATE
+#define FRAME_RATE 100
+#endif
+#ifndef SERIAL_BAUD
+#define SERIAL_BAUD 500000 // Serial1, SerialUSB runs at USB speed whatever is set
+#endif
+#ifndef STRIP_TYPE
+#define STRIP_TYPE (NEO_GRB + NEO_KHZ800)
+#endif
+
+static_assert(STRIP_COUNT * STRIP_LENGTH == NUM_LEDS, "the canvas has to cover the strips exactly");
+
+#ifdef ARDUINO
+#include <Adafruit_NeoPixel_ZeroDMA.h>
+//#include <Adafruit_NeoPixel.h>
+
+using TStripType = Adafruit_NeoPixel_ZeroDMA;
+//using TStripType = Adafruit_NeoPixel;
+using TSerialType = Stream;
+
+inline void WaitForInterrupt() {
+    __WFI();
+}
+
+// the SAMD21 has no random number generator, the lowest ADC bit of the analog inputs is noise
+inline uint32_t GetEntropy() {
+    uint32_t entropy = 0;
+    for (unsigned int i = 0; i < 32; ++i) {
+        entropy = (entropy << 1) | ((analogRead(A0) ^ analogRead(A1) ^ analogRead(A2)) & 1);
+    }
+    return entropy ^ micros();
+}
+#else
+#include "native.h"
+
+using TStripType = TSimulatedStrip;
+using TSerialType = TSimulatedSerial;
+#endif
+
+template <typename T, const unsigned int N>
+constexpr unsigned int countof(T (&)[N]) { return N; }
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "platform.h"
+
+// Render timing per actor, from micros() as the Cortex-M0+ has no cycle counter. Building with
+// -DLED300_PROFILE=0 leaves empty inline hooks that compile to nothing.
+#ifndef LED300_PROFILE
+#define LED300_PROFILE 1
+#endif
+
+#define PROFILE_MAX_ACTORS 12 // actor names kept apart, later ones share the last entry
+
+// min, average and max of one stage, us
+struct TStageStats {
+    uint32_t Count = 0;
+    uint32_t Total = 0;
+    uint32_t Min = 0xFFFFFFFF;
+    uint32_t Max = 0;
+
+    void Add(uint32_t time) {
+        ++Count;
+        Total += time;
+        Min = min(Min, time);
+        Max = max(Max, time);
+    }
+
+    void Print(TSerialType& port, const char* name) const {
+        port.print(name);
+        port.print(' ');
+        port.print(Count != 0 ? Min : 0);
+        port.print('/');
+        port.print(Count != 0 ? Total / Count : 0);
+        port.print('/');
+        port.print(Max);
+    }
+};
+
+struct TActorProfile {
+    static constexpr unsigned int HISTOGRAM_SIZE = 6;
+
+    const char* Name = nullptr;
+    TStageStats Move; // includes the Draw of the actor and of its children
+    TStageStats Draw;
+    TStageStats Show;
+    TStageStats Frame;
+    uint32_t Histogram[HISTOGRAM_SIZE] = {};
+    uint32_t Overruns = 0;
+    uint32_t ActiveTime = 0; // ms the actor has been current, for its frame rate
+
+    void AddFrame(uint32_t time) {
+        Frame.Add(time);
+        // upper bounds of the buckets, us, the last bucket takes the rest
+        static const uint32_t limits[HISTOGRAM_SIZE - 1] = {1000, 2000, 5000, 10000, 20000};
+        unsigned int bucket = 0;
+        while (bucket < countof(limits) && time >= limits[bucket]) {
+            ++bucket;
+        }
+        ++Histogram[bucket];
+    }
+};
+
+#if LED300_PROFILE
+
+// The main loop brackets every frame with BeginFrame() .. EndFrame(), the actors report their
+// Draw() time from DrawIfChanged(). Everything is booked on the actor named by the last Select(),
+// so a crossfade counts towards the actor fading in.
+class TProfiler {
+public:
+    static TProfiler& Get() {
+        static TProfiler profiler;
+        return profiler;
+    }
+
+    void Select(const char* name) {
+        Leave();
+        Current = &Profiles[0];
+        while (Current != &Profiles[PROFILE_MAX_ACTORS - 1] && Current->Name != nullptr && strcmp(Current->Name, name) != 0) {
+            ++Current;
+        }
+        Current->Name = name;
+        SelectTime = millis();
+    }
+
+    void BeginFrame() {
+        FrameStart = StageStart = micros();
+        DrawTime = 0;
+        Drawn = false;
+    }
+
+    void AddDraw(uint32_t time) {
+        DrawTime += time;
+        Drawn = true;
+    }
+
+    void EndMove() {
+        uint32_t now = micros();
+        if (Current != nullptr) {
+            Current->Move.Add(now - StageStart);
+            if (Drawn) {
+                Current->Draw.Add(DrawTime);
+            }
+        }
+        StageStart = now;
+    }
+
+    void EndShow() {
+        uint32_t now = micros();
+        if (Current != nullptr) {
+            Current->Show.Add(now - StageStart);
+        }
+        StageStart = now;
+    }
+
+    void EndFrame(bool overrun) {
+        if (Current != nullptr) {
+            Current->AddFrame(micros() - FrameStart);
+            Current->Overruns += overrun;
+        }
+    }
+
+    void Print(TSerialType& port) {
+        Leave();
+        SelectTime = millis();
+        port.println("Actor: min/avg/max us of move, draw, show, frame; frames by time (<1,<2,<5,<10,<20,>=20 ms); overruns; fps");
+        for (const TActorProfile& profile : Profiles) {
+            if (profile.Name == nullptr) {
+                break;
+            }
+            port.print(profile.Name);
+            port.print(": ");
+            profile.Move.Print(port, "move");
+            profile.Draw.Print(port, ", draw");
+            profile.Show.Print(port, ", show");
+            profile.Frame.Print(port, ", frame");
+            port.print(';');
+            for (uint32_t count : profile.Histogram) {
+                port.print(' ');
+                port.print(count);
+            }
+            port.print("; ");
+            port.print(profile.Overruns);
+            port.print("; ");
+            port.println(profile.ActiveTime != 0 ? profile.Frame.Count * 1000.0 / profile.ActiveTime : 0.0);
+        }
+    }
+
+    // keeps the current actor selected
+    void Reset() {
+        const char* name = Current != nullptr ? Current->Name : nullptr;
+        for (TActorProfile& profile : Profiles) {
+            profile = TActorProfile();
+        }
+        Current = nullptr;
+        if (name != nullptr) {
+            Select(name);
+        }
+    }
+
+protected:
+    TActorProfile Profiles[PROFILE_MAX_ACTORS];
+    TActorProfile* Current = nullptr;
+    uint32_t SelectTime = 0; // ms
+    uint32_t FrameStart = 0; // us
+    uint32_t StageStart = 0; // us
+    uint32_t DrawTime = 0; // us
+    bool Drawn = false;
+
+    void Leave() {
+        if (Current != nullptr) {
+            Current->ActiveTime += millis() - SelectTime;
+        }
+    }
+};
+
+#else
+
+class TProfiler {
+public:
+    static TProfiler& Get() {
+        static TProfiler profiler;
+        return profiler;
+    }
+
+    void Select(const char*) {}
+    void BeginFrame() {}
+    void AddDraw(uint32_t) {}
+    void EndMove() {}
+    void EndShow() {}
+    void EndFrame(bool) {}
+
+    void Print(TSerialType& port) {
+        port.println("Profiling is compiled out, build with LED300_PROFILE=1");
+    }
+
+    void Reset() {}
+};
+
+#endif
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "platform.h"
+
+// xorshift32: three shifts and xors per number, no division, and a seed makes a show repeatable.
+// Arduino's random() goes through rand() and a modulo, which the M0+ has to do in software.
+class TRandom {
+public:
+    static constexpr uint32_t DEFAULT_SEED = 0x2545F491;
+
+    static TRandom& Get() {
+        static TRandom random;
+        return random;
+    }
+
+    // 0 would stick at 0, it stands for DEFAULT_SEED
+    void Seed(uint32_t seed) {
+        SeedValue = seed;
+        State = seed != 0 ? seed : DEFAULT_SEED;
+    }
+
+    uint32_t GetSeed() const {
+        return SeedValue;
+    }
+
+    uint32_t Next() {
+        uint32_t x = State;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        return State = x;
+    }
+
+    // 0..range-1 for range up to 0x10000, scaling the top 16 bits with one 32 bit multiply
+    uint32_t Below(uint32_t range) {
+        return ((Next() >> 16) * range) >> 16;
+    }
+
+    // packed 0xRRGGBB with every channel 0..255
+    uint32_t Color() {
+        return Next() & 0xFFFFFF;
+    }
+
+    // packed 0xRRGGBB with every channel 0..limit-1, limit a power of two up to 256
+    uint32_t Color(uint32_t limit) {
+        return Next() & ((limit - 1) * 0x010101);
+    }
+
+    void FillColors(uint32_t* colors, unsigned int count) {
+        while (count-- != 0) {
+            *colors++ = Color();
+        }
+    }
+
+protected:
+    uint32_t State = DEFAULT_SEED;
+    uint32_t SeedValue = 0;
+};
+
+inline uint32_t RandomBelow(uint32_t range) {
+    return TRandom::Get().Below(range);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "platform.h"
+
+// Paces frames on a fixed grid of FramePeriod, skips grid slots while the actor is idle
+// and lets the CPU sleep until the next slot is due.
+class TFrameScheduler {
+public:
+    static constexpr uint32_t MAX_IDLE_TIME = 1000; // ms
+    static constexpr uint32_t MAX_FRAME_RATE = 1000; // keeps FramePeriod from reaching 0
+
+    uint32_t FramePeriod; // us
+    uint32_t NextFrameTime = 0; // us
+    uint32_t Frames = 0;
+    uint32_t Overruns = 0;
+
+    TFrameScheduler(uint32_t frameRate) {
+        SetFrameRate(frameRate);
+    }
+
+    // clamped to 1..MAX_FRAME_RATE
+    void SetFrameRate(uint32_t frameRate) {
+        FramePeriod = 1000000 / min(max(frameRate, 1u), MAX_FRAME_RATE);
+    }
+
+    bool IsFrameTime(uint32_t now) const {
+        return int32_t(now - NextFrameTime) >= 0;
+    }
+
+    // moves to the first grid slot after the frame that has just been rendered at or after idleTime (ms) from now
+    void EndFrame(uint32_t now, uint32_t idleTime) {
+        ++Frames;
+        NextFrameTime += FramePeriod;
+        if (int32_t(now - NextFrameTime) >= 0) {
+            // the frame took longer than its slot, start the grid over
+            ++Overruns;
+            NextFrameTime = now;
+        }
+        uint32_t wake = now + min(idleTime, MAX_IDLE_TIME) * 1000;
+        if (int32_t(wake - NextFrameTime) > 0) {
+            NextFrameTime += (wake - NextFrameTime + FramePeriod - 1) / FramePeriod * FramePeriod;
+        }
+    }
+
+    // renders the next frame as soon as possible, e.g. after the actor was replaced
+    void Wake() {
+        NextFrameTime = micros();
+    }
+
+    // sleeps until the next interrupt (at most a SysTick) unless a frame is due
+    void Idle() const {
+        if (!IsFrameTime(micros())) {
+            WaitForInterrupt();
+        }
+    }
+
+    void ResetCounters() {
+        Frames = 0;
+        Overruns = 0;
+    }
+};
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "platform.h"
+#include "canvas.h"
+
 template <int Size>
 struct TSprite {
     using ImageType = uint32_t[Size];
@@ -20,35 +23,60 @@ struct TAnimation {
         return Size;
     }
 
-    uint32_t GetTotalDuration() const {
-        uint32_t duration = 0;
-        for (const auto& sprite : Sprites) {
-            duration += sprite.Duration;
-        }
-        return duration;
+    constexpr uint32_t GetDuration(int sprite) const {
+        return Sprites[sprite].Duration;
+    }
+
+    // time from the start of the animation to the end of sprite index. Folded at compile time for
+    // constexpr animations, which is how the packer stores them; at runtime it walks the sprites.
+    constexpr uint32_t GetEndTime(int index) const {
+        return index < 0 ? 0 : Sprites[index].Duration + GetEndTime(index - 1);
+    }
+
+    constexpr uint32_t GetTotalDuration() const {
+        return GetEndTime(Count - 1);
+    }
+
+    template <unsigned int Length>
+    void Draw(TCanvasOf<Length>& canvas, int sprite, unsigned int position) const {
+        canvas.Write(position, Sprites[sprite].Image, Size);
     }
 };
 
+// One running instance of an animation. Time only moves forward between Start() calls, so the
+// play keeps a cursor on its current sprite and steps it forward instead of searching.
 struct TAnimationPlay {
     uint32_t StartTime;
+    int Next; // sprites up to Next - 1 are accounted for in End
+    uint32_t End; // end of sprite Next - 1, relative to StartTime
 
     TAnimationPlay()
         : StartTime(0)
+        , Next(0)
+        , End(0)
     {}
 
     void Start(uint32_t time) {
         StartTime = time;
+        Next = 0;
+        End = 0;
     }
 
+    // -1 once the animation is over, time mustn't be before the start
     template <typename AnimationType>
-    const typename AnimationType::ImageType* GetCurrentImage(const AnimationType& animation, uint32_t time) const {
+    int GetCurrentSprite(const AnimationType& animation, uint32_t time) {
         uint32_t delta = time - StartTime;
-        for (unsigned int i = 0; i < animation.GetCount(); ++i) {
-            if (delta < animation.Sprites[i].Duration) {
-                return &animation.Sprites[i].Image;
-            }
-            delta -= animation.Sprites[i].Duration;
+        while (delta >= End && Next < animation.GetCount()) {
+            End = animation.GetEndTime(Next++);
         }
-        return nullptr;
+        return delta < End ? Next - 1 : -1;
+    }
+
+    // ms from time until the sprite changes as of the last GetCurrentSprite(), 0 when the cursor is
+    // behind, 0xFFFFFFFF once the animation is over
+    template <typename AnimationType>
+    uint32_t GetTimeLeft(const AnimationType& animation, uint32_t time) const {
+        uint32_t delta = time - StartTime;
+        return delta < End ? End - delta : Next < animation.GetCount() ? 0 : 0xFFFFFFFF;
     }
 };
@@ -0,0 +1,326 @@
+#pragma once
+
+#include "platform.h"
+#include "actors.h"
+
+#define STREAM_READ_SIZE 256 // bytes taken off a port per call, bounds the time spent per loop
+#define STREAM_TIMEOUT 100 // ms without a byte before a started frame is given up
+
+class TFletcher16 {
+public:
+    void Add(uint8_t c) {
+        Sum1 += c;
+        if (Sum1 >= 255) {
+            Sum1 -= 255;
+        }
+        Sum2 += Sum1;
+        if (Sum2 >= 255) {
+            Sum2 -= 255;
+        }
+    }
+
+    uint16_t Get() const {
+        return (Sum2 << 8) | Sum1;
+    }
+
+protected:
+    uint16_t Sum1 = 0;
+    uint16_t Sum2 = 0;
+};
+
+// Binary frames pushed by a host, next to the text commands on the same port:
+//   0xA5 0x5A, type, payload length (2 bytes, low first), payload,
+//   Fletcher-16 of type, length and payload (2 bytes, low first)
+// A frame is received into the back buffer and becomes the front buffer by swapping the
+// two pointers once its checksum matched, so a half received frame is never shown.
+//
+// A TYPE_FULL payload is NUM_LEDS * RGB. A TYPE_UPDATE payload is a list of operations on
+// a copy of the last frame, decoded straight into the back buffer as the bytes arrive.
+// Positions and counts are in pixels, 2 byte values are low first:
+//   OP_SPAN start(2) count(1) count * RGB    changed pixels
+//   OP_FILL start(2) count(2) RGB            run of one colour
+//   OP_SCROLL by(2)                          every pixel moves up by pixels, wrapping around
+class TFrameReceiver {
+public:
+    static constexpr uint8_t MAGIC_0 = 0xA5;
+    static constexpr uint8_t MAGIC_1 = 0x5A;
+    static constexpr uint8_t TYPE_FULL = 0x01;
+    static constexpr uint8_t TYPE_UPDATE = 0x02;
+    static constexpr uint8_t OP_SPAN = 0x01;
+    static constexpr uint8_t OP_FILL = 0x02;
+    static constexpr uint8_t OP_SCROLL = 0x03;
+    static constexpr unsigned int FRAME_SIZE = NUM_LEDS * 3;
+
+    // takes a frame's bytes off the port, text is left for the command line.
+    // true when a new frame has been swapped in
+    bool Read(TSerialType& port) {
+        if (State != EState::Idle) {
+            if (&port != Owner) {
+                return false;
+            }
+            if (millis() - LastByteTime > STREAM_TIMEOUT) {
+                Fail();
+            }
+        }
+        for (unsigned int n = 0; n < STREAM_READ_SIZE && port.available(); ++n) {
+            if (State == EState::Idle) {
+                if (port.peek() < 0x80) {
+                    return false;
+                }
+                if (port.read() == MAGIC_0) {
+                    State = EState::Magic;
+                    Owner = &port;
+                } else {
+                    ++Errors;
+                }
+                LastByteTime = millis();
+                continue;
+            }
+            uint8_t c = port.read();
+            LastByteTime = millis();
+            if (Receive(c)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // while a frame is coming in on a port, its payload must not be taken for text
+    bool IsReceiving(const TSerialType& port) const {
+        return State != EState::Idle && Owner == &port;
+    }
+
+    // RGB bytes of the last complete frame
+    const uint8_t* GetFrame() const {
+        return Front;
+    }
+
+    uint32_t Frames = 0;
+    uint32_t Errors = 0;
+
+protected:
+    enum class EState : uint8_t {
+        Idle,
+        Magic,
+        Type,
+        Length,
+        Payload,
+        Check,
+    };
+
+    uint8_t Buffers[2][FRAME_SIZE] = {};
+    uint8_t* Front = Buffers[0];
+    uint8_t* Back = Buffers[1];
+    EState State = EState::Idle;
+    TSerialType* Owner = nullptr;
+    uint32_t LastByteTime = 0;
+    uint8_t Type = 0;
+    unsigned int Position = 0;
+    unsigned int Length = 0;
+    TFletcher16 Sum;
+    uint16_t Check = 0;
+    // update decoding
+    bool Bad = false;
+    uint8_t Op = 0;
+    uint8_t Args[7];
+    unsigned int ArgCount = 0;
+    uint8_t* SpanTarget = nullptr;
+    unsigned int SpanLeft = 0; // bytes
+
+    static unsigned int GetArgSize(uint8_t op) {
+        switch (op) {
+            case OP_SPAN:
+                return 3;
+            case OP_FILL:
+                return 7;
+            case OP_SCROLL:
+                return 2;
+        }
+        return 0;
+    }
+
+    // reverses the order of the pixels first..last-1
+    static void ReversePixels(uint8_t* pixels, unsigned int first, unsigned int last) {
+        uint8_t* a = pixels + first * 3;
+        uint8_t* b = pixels + last * 3;
+        while (b - a > 3) {
+            b -= 3;
+            for (int c = 0; c < 3; ++c) {
+                uint8_t t = a[c];
+                a[c] = b[c];
+                b[c] = t;
+            }
+            a += 3;
+        }
+    }
+
+    void Execute() {
+        unsigned int start = Args[0] | (unsigned(Args[1]) << 8);
+        switch (Op) {
+            case OP_SPAN: {
+                unsigned int count = Args[2];
+                Bad |= count == 0 || start + count > NUM_LEDS;
+                SpanTarget = Bad ? nullptr : Back + start * 3;
+                SpanLeft = count * 3;
+                break;
+            }
+            case OP_FILL: {
+                unsigned int count = Args[2] | (unsigned(Args[3]) << 8);
+                if (start + count > NUM_LEDS) {
+                    Bad = true;
+                    break;
+                }
+                for (uint8_t* p = Back + start * 3; count != 0; --count, p += 3) {
+                    p[0] = Args[4];
+                    p[1] = Args[5];
+                    p[2] = Args[6];
+                }
+                break;
+            }
+            case OP_SCROLL: {
+                unsigned int by = start % NUM_LEDS;
+                if (by != 0) {
+                    // rotating right by reversing all, then both parts
+                    ReversePixels(Back, 0, NUM_LEDS);
+                    ReversePixels(Back, 0, by);
+                    ReversePixels(Back, by, NUM_LEDS);
+                }
+                break;
+            }
+        }
+    }
+
+    void Decode(uint8_t c) {
+        if (SpanLeft != 0) {
+            if (SpanTarget != nullptr) {
+                *SpanTarget++ = c;
+            }
+            --SpanLeft;
+        } else if (Op == 0) {
+            Op = c;
+            ArgCount = 0;
+            if (GetArgSize(Op) == 0) {
+                Bad = true;
+                Op = 0;
+            }
+        } else {
+            Args[ArgCount++] = c;
+            if (ArgCount == GetArgSize(Op)) {
+                Execute();
+                Op = 0;
+            }
+        }
+    }
+
+    void Fail() {
+        ++Errors;
+        State = EState::Idle;
+    }
+
+    bool Receive(uint8_t c) {
+        switch (State) {
+            case EState::Magic:
+                if (c != MAGIC_1) {
+                    Fail();
+                    break;
+                }
+                Sum = TFletcher16();
+                State = EState::Type;
+                break;
+            case EState::Type:
+                if (c != TYPE_FULL && c != TYPE_UPDATE) {
+                    Fail();
+                    break;
+                }
+                Sum.Add(c);
+                Type = c;
+                Position = 0;
+                Length = 0;
+                State = EState::Length;
+                break;
+            case EState::Length:
+                Sum.Add(c);
+                Length |= unsigned(c) << (8 * Position);
+                if (++Position == 2) {
+                    if (Type == TYPE_FULL && Length != FRAME_SIZE) {
+                        Fail();
+                        break;
+                    }
+                    if (Type == TYPE_UPDATE) {
+                        memcpy(Back, Front, FRAME_SIZE);
+                        Bad = false;
+                        Op = 0;
+                        SpanLeft = 0;
+                    }
+                    Position = 0;
+                    Check = 0;
+                    State = Length != 0 ? EState::Payload : EState::Check;
+                }
+                break;
+            case EState::Payload:
+                Sum.Add(c);
+                if (Type == TYPE_FULL) {
+                    Back[Position] = c;
+                } else {
+                    Decode(c);
+                }
+                if (++Position == Length) {
+                    Position = 0;
+                    State = EState::Check;
+                }
+                break;
+            case EState::Check:
+                Check |= uint16_t(c) << (8 * Position);
+                if (++Position == 2) {
+                    // an update cut off inside an operation is as bad as a wrong checksum
+                    bool bad = Type == TYPE_UPDATE && (Bad || Op != 0 || SpanLeft != 0);
+                    if (Check != Sum.Get() || bad) {
+                        Fail();
+                        break;
+                    }
+                    uint8_t* frame = Back;
+                    Back = Front;
+                    Front = frame;
+                    ++Frames;
+                    State = EState::Idle;
+                    return true;
+                }
+                break;
+            case EState::Idle:
+                break;
+        }
+        return false;
+    }
+};
+
+// Shows the frames a host streams in, redrawing only when a new one has arrived.
+class TStreamActor : public TActor {
+public:
+    TStreamActor(const TFrameReceiver& receiver)
+        : Receiver(receiver)
+    {}
+
+    virtual void Draw(TCanvas& canvas) override {
+        const uint8_t* rgb = Receiver.GetFrame();
+        uint32_t* pixels = canvas.GetPixels();
+        for (unsigned int i = 0; i < NUM_LEDS; ++i, rgb += 3) {
+            pixels[i] = (uint32_t(rgb[0]) << 16) | (uint32_t(rgb[1]) << 8) | rgb[2];
+        }
+    }
+
+    virtual bool Move(TCanvas& canvas, uint32_t) override {
+        if (Receiver.Frames != DrawnFrames) {
+            DrawnFrames = Receiver.Frames;
+            Invalidate();
+        }
+        return DrawIfChanged(canvas);
+    }
+
+    virtual uint32_t GetIdleTime(uint32_t) const override {
+        return Changed ? 0 : IDLE_FOREVER;
+    }
+
+protected:
+    const TFrameReceiver& Receiver;
+    uint32_t DrawnFrames = 0;
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <new>
+#include "platform.h"
+
+// The physical outputs behind the canvas, strip i shows pixels i * STRIP_LENGTH onwards.
+// Each Adafruit_NeoPixel_ZeroDMA strip has its own DMA channel and show() only starts the
+// transfer, so showing the strips one after another refreshes them all in parallel.
+class TStripSet {
+public:
+    static constexpr unsigned int WIRE_TIME = STRIP_LENGTH * 30 + 300; // us per refresh at 800 kHz, with the latch
+
+    // the strip library can't be copied or default constructed, so the strips are built in place
+    TStripSet(const uint8_t (&pins)[STRIP_COUNT], uint16_t type) {
+        for (unsigned int s = 0; s < STRIP_COUNT; ++s) {
+            ::new (Storage[s].Data) TStripType(STRIP_LENGTH, pins[s], type);
+        }
+    }
+
+    static constexpr unsigned int GetCount() {
+        return STRIP_COUNT;
+    }
+
+    TStripType& operator [](unsigned int index) {
+        return *reinterpret_cast<TStripType*>(Storage[index].Data);
+    }
+
+    void Begin() {
+        for (unsigned int s = 0; s < STRIP_COUNT; ++s) {
+            (*this)[s].begin();
+        }
+    }
+
+protected:
+    struct TSlot {
+        alignas(TStripType) uint8_t Data[sizeof(TStripType)];
+    };
+
+    TSlot Storage[STRIP_COUNT];
+};
+
+// Refresh timing of one strip. ShowTime covers filling its bytes and show(), which waits
+// for the strip's previous transfer, so a ShowTime near WIRE_TIME means the strip holds back the frame rate.
+struct TStripStats {
+    uint32_t Shows = 0;
+    uint32_t ShowTime = 0; // us, summed
+    uint32_t MaxShowTime = 0; // us
+};
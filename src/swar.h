@@ -0,0 +1,116 @@
+#pragma once
+
+#include "platform.h"
+
+// Channel arithmetic on packed 0x00RRGGBB words, a few channels per 32 bit operation:
+// R and B are worked on together with 8 bits of room above each, G on its own. Guard bits
+// above the channels turn carries and borrows into 0xFF masks, so nothing branches per channel.
+// Every kernel has a span version that works in place over a buffer.
+class TSwar {
+public:
+    static constexpr uint32_t RB = 0xFF00FF;
+    static constexpr uint32_t G = 0x00FF00;
+
+    // per channel min(a + b, 255)
+    static uint32_t Add(uint32_t a, uint32_t b) {
+        uint32_t rb = (a & RB) + (b & RB);
+        uint32_t g = (a & G) + (b & G);
+        uint32_t rbCarry = rb & 0x1000100;
+        uint32_t gCarry = g & 0x0010000;
+        rb |= rbCarry - (rbCarry >> 8);
+        g |= gCarry - (gCarry >> 8);
+        return (rb & RB) | (g & G);
+    }
+
+    // per channel max(a - b, 0), the guard bit above a channel survives the subtraction when a >= b
+    static uint32_t Sub(uint32_t a, uint32_t b) {
+        uint32_t rb = ((a & RB) | 0x1000100) - (b & RB);
+        uint32_t g = ((a & G) | 0x0010000) - (b & G);
+        uint32_t rbKeep = rb & 0x1000100;
+        uint32_t gKeep = g & 0x0010000;
+        return (rb & (rbKeep - (rbKeep >> 8))) | (g & (gKeep - (gKeep >> 8)));
+    }
+
+    // per channel max(a, b), by the same guard bits as Sub
+    static uint32_t Max(uint32_t a, uint32_t b) {
+        uint32_t rbKeep = (((a & RB) | 0x1000100) - (b & RB)) & 0x1000100;
+        uint32_t gKeep = (((a & G) | 0x0010000) - (b & G)) & 0x0010000;
+        uint32_t mask = (rbKeep - (rbKeep >> 8)) | (gKeep - (gKeep >> 8));
+        return ((a & mask) | (b & ~mask)) & 0xFFFFFF;
+    }
+
+    // per channel c * scale / 256, scale 0..256
+    static uint32_t Scale(uint32_t color, uint32_t scale) {
+        uint32_t rb = ((color & RB) * scale >> 8) & RB;
+        uint32_t g = ((color & G) * scale >> 8) & G;
+        return rb | g;
+    }
+
+    // a + (b - a) * amount / 256 rounded, amount 0..256, the two weights sum up to 256 so channels can't carry
+    static uint32_t Lerp(uint32_t a, uint32_t b, uint32_t amount) {
+        uint32_t rb = (a & RB) * (256 - amount) + (b & RB) * amount + 0x800080;
+        uint32_t g = (a & G) * (256 - amount) + (b & G) * amount + 0x008000;
+        return ((rb >> 8) & RB) | ((g >> 8) & G);
+    }
+
+    // per channel a * b / 255 rounded, the channels multiply apart and are divided by 255 two at a time
+    static uint32_t Multiply(uint32_t a, uint32_t b) {
+        uint32_t rb = ((a >> 16) & 0xFF) * ((b >> 16) & 0xFF) << 16 | (a & 0xFF) * (b & 0xFF);
+        uint32_t g = ((a >> 8) & 0xFF) * ((b >> 8) & 0xFF);
+        rb += 0x800080;
+        g += 0x80;
+        rb = ((rb + ((rb >> 8) & RB)) >> 8) & RB;
+        g = ((g + (g >> 8)) >> 8) & 0xFF;
+        return rb | (g << 8);
+    }
+
+    static void Add(uint32_t* pixels, const uint32_t* colors, unsigned int count) {
+        for (unsigned int i = 0; i < count; ++i) {
+            pixels[i] = Add(pixels[i], colors[i]);
+        }
+    }
+
+    static void Sub(uint32_t* pixels, const uint32_t* colors, unsigned int count) {
+        for (unsigned int i = 0; i < count; ++i) {
+            pixels[i] = Sub(pixels[i], colors[i]);
+        }
+    }
+
+    static void Max(uint32_t* pixels, const uint32_t* colors, unsigned int count) {
+        for (unsigned int i = 0; i < count; ++i) {
+            pixels[i] = Max(pixels[i], colors[i]);
+        }
+    }
+
+    static void Scale(uint32_t* pixels, uint32_t scale, unsigned int count) {
+        for (unsigned int i = 0; i < count; ++i) {
+            pixels[i] = Scale(pixels[i], scale);
+        }
+    }
+
+    // pixels move amount / 256 of the way to colors
+    static void Lerp(uint32_t* pixels, const uint32_t* colors, uint32_t amount, unsigned int count) {
+        for (unsigned int i = 0; i < count; ++i) {
+            pixels[i] = Lerp(pixels[i], colors[i], amount);
+        }
+    }
+
+    static void Lerp(uint32_t* pixels, const uint32_t* a, const uint32_t* b, uint32_t amount, unsigned int count) {
+        for (unsigned int i = 0; i < count; ++i) {
+            pixels[i] = Lerp(a[i], b[i], amount);
+        }
+    }
+
+    static void Multiply(uint32_t* pixels, const uint32_t* colors, unsigned int count) {
+        for (unsigned int i = 0; i < count; ++i) {
+            pixels[i] = Multiply(pixels[i], colors[i]);
+        }
+    }
+
+    // every pixel multiplied by the same mask colour
+    static void Multiply(uint32_t* pixels, const uint32_t* colors, uint32_t mask, unsigned int count) {
+        for (unsigned int i = 0; i < count; ++i) {
+            pixels[i] = Multiply(colors[i], mask);
+        }
+    }
+};